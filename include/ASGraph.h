@@ -2,52 +2,337 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 
 #include "ASNode.h"
 #include "Announcement.h"
+#include "CSRGraph.h"
+#include "PhaseArena.h"
+#include "PrefixIndex.h"
+#include "PrefixTable.h"
+#include "RIBStore.h"
+#include "WorkStealingPool.h"
+
+// How an AS collects the routes offered to it during a propagation step
+enum class ReceiveMode {
+    // Keep only the best offer per receiving AS, compared on arrival
+    Streaming,
+    // Queue every offer and reduce the queue after the step (reference mode)
+    Queued
+};
+
+// Counters from the last ASGraph::propagateAnnouncements() call
+struct PropagationStats {
+    uint64_t prefixes = 0;           // prefixes that had routes to propagate
+    uint64_t shared = 0;             // prefixes that reused the routes of an identically seeded one
+    uint64_t offers = 0;             // routes sent to a neighbor that accepted them
+    uint64_t steps = 0;              // send/process steps
+    uint64_t peak_pending = 0;       // most offers (queued) or candidates (streaming) held in one step
+    uint64_t arena_heap_blocks = 0;  // blocks the offer arena had to take from the heap (queued)
+    size_t arena_bytes = 0;          // offer arena buffer size at the end of the run (queued)
+    unsigned shards = 1;             // prefix shards propagated concurrently
+    // Serial engine: ASes that sent in each phase, against the `scanned` ASes
+    // a phase would visit if it walked the whole graph (both summed over prefixes)
+    uint64_t sent_up = 0, sent_across = 0, sent_down = 0;
+    uint64_t scanned = 0;
+
+    // Fold in the counters of another shard
+    void merge(const PropagationStats& other);
+};
+
+// Buffers reused by every prefix of a propagation run (one per prefix shard)
+struct PropagationScratch {
+    PropagationStats stats;
+    RouteColumns work;              // routes of the prefix being propagated, one row per AS
+    RouteColumns best;              // streaming: best offer per AS in the current step
+    std::vector<uint32_t> touched;  // streaming: ASes with a row in `best`
+    std::vector<std::vector<uint32_t>> frontier;  // ASes holding a route, by rank
+    PhaseArena arena;               // queued: offers of the current step
+};
+
+// How ASGraph::dumpRIBsToCSV formats and orders its rows
+struct RIBDumpOptions {
+    // Threads formatting rows (0 = one per core). The file is the same for
+    // any count.
+    unsigned threads = 1;
+    // Order each AS's rows by prefix (IPv4 before IPv6, then address, then
+    // length) rather than by prefix ID, which follows the input order. The
+    // rows are the same either way; shard merges need the default order.
+    bool sort_prefixes = false;
+    // Only the rows of these ASNs / prefix IDs (unset = every one); unknown
+    // ASNs and prefixes without routes are ignored
+    std::optional<std::vector<uint32_t>> asns;
+    std::optional<std::vector<uint32_t>> prefixes;
+};
+
+class RIBSink;
 
 class ASGraph {
-    std::unordered_map<uint32_t, std::shared_ptr<ASNode>> _node_map; // Maps asn to ASNode object
+    std::vector<ASNode> _nodes;                     // Dense index -> ASNode
+    std::unordered_map<uint32_t, uint32_t> _index;  // Maps asn to dense index (cold paths only)
+    PrefixTable _prefixes;                          // Prefix text <-> prefix ID used by RIBs
+    std::vector<PrefixRIB> _ribs;                   // Prefix ID -> route of every AS
+    PrefixIndex _prefix_index;                      // Longest-prefix match over _prefixes
+    std::vector<uint32_t> _route_owner;             // Prefix ID -> prefix whose RIB holds its routes
+    bool _share_prefixes = true;
+    PrefixShard _shard;                             // Prefixes loadAnnouncementsFromFile keeps
+    std::vector<uint32_t> _prefix_ordinals;         // Prefix ID -> position among all prefixes of the file (shards only)
+    PropagationStats _stats;
+    ReceiveMode _receive_mode = ReceiveMode::Streaming;
+    unsigned _threads = 1;
+    unsigned _prefix_shards = 1;
+    bool _propagated = false;  // the RIBs hold the propagated seeds (see announce())
+
+    // Import rules of every AS, read from the policies when propagation starts
+    std::vector<uint8_t> _drops_invalid;  // AS index -> 1 if it drops ROV-invalid routes
+    bool _any_drops_invalid = false;
+    bool _custom_import = false;          // some AS needs acceptsAnnouncement() per route
+
+    // Edges as added, in dense indices. The CSR arrays are (re)built from these
+    // lazily, so incremental addProvider/addPeer calls stay cheap.
+    std::vector<std::pair<uint32_t, uint32_t>> _provider_edges; // (provider, customer)
+    std::vector<std::pair<uint32_t, uint32_t>> _peer_edges;
+    mutable CSRGraph _csr;
+    mutable bool _csr_dirty = false;
+    // Set after loading a snapshot: the CSR arrays are authoritative and the
+    // edge lists are only recovered from them if the topology is edited.
+    bool _edges_from_csr = false;
+
+    // Result of the rank pass, cached until the topology changes: either the
+    // propagation ranks (dense indices) or the ASNs of a provider cycle.
+    std::vector<std::vector<uint32_t>> _ranks;
+    std::vector<uint32_t> _provider_cycle;
+    bool _ranks_valid = false;
+
+    void computeRanks();
+    std::vector<uint32_t> findCycleComponent(const std::vector<uint32_t>& remaining) const;
+
+    const CSRGraph& adjacency() const;
+    void materializeEdges();
+    std::vector<uint32_t> toASNs(CSRGraph::Range r) const;
+
+    // Ranks as dense indices; see flattenByProviders()
+    const std::vector<std::vector<uint32_t>>& rankIndices();
+
+    // Run up/across/down for one prefix on the dense columns `scratch.work`.
+    // accepts(node, rov_invalid) is the import filter of AS index `node`.
+    template <typename Filter>
+    void propagatePrefix(PrefixRIB& rib, PropagationScratch& scratch, const Filter& accepts) const;
+    // The filter of each AS's Policy
+    bool policyAccepts(uint32_t node, bool rov_invalid) const { return _nodes[node].policy->acceptsAnnouncement(rov_invalid); }
+    // Same result, with the ASes of each rank processed on `pool`
+    template <typename Filter>
+    void propagatePrefixParallel(PrefixRIB& rib, PropagationScratch& scratch, WorkStealingPool& pool,
+                                 const Filter& accepts);
+
+    // Fill the import rule table from the policies
+    void refreshImportRules();
+    // Call body(filter) with the cheapest import filter that is exact for
+    // `rib`: none if no route can be dropped, the ROV table if only built-in
+    // rules are in use, otherwise the policies themselves
+    template <typename Body>
+    void withImportFilter(const PrefixRIB& rib, Body&& body) const;
+
+    static constexpr uint32_t kNoNode = UINT32_MAX;
+    // Add `ann` to the seeds of its prefix at `asn`; returns the AS index, or
+    // kNoNode if the prefix ID is unknown
+    uint32_t recordSeed(uint32_t asn, const Announcement& ann);
+    // Best seed of `node` that its import filter accepts (rel 0 if none)
+    RouteEntry seedRoute(const PrefixRIB& rib, uint32_t node) const;
+    // Drop the routes of `rib` and store its seeds again through the policies
+    void reseed(PrefixRIB& rib);
+    // RIB holding the routes of `prefix`: its own, or that of the identically
+    // seeded prefix propagated in its place
+    const PrefixRIB& routesOf(uint32_t prefix) const {
+        return _ribs[prefix < _route_owner.size() ? _route_owner[prefix] : prefix];
+    }
+    // Output order of the RIB writers: AS indices by ASN, and the prefix IDs
+    // whose rows each AS lists
+    std::vector<uint32_t> outputNodes(const RIBDumpOptions& options) const;
+    std::vector<uint32_t> outputPrefixes(const RIBDumpOptions& options) const;
+    // Fill _route_owner for a run and drop from `todo` every prefix whose
+    // seeds match an earlier one's
+    void groupBySeeds(std::vector<uint32_t>& todo);
+    // Give `prefix` routes of its own again before its seeds change
+    void unshare(uint32_t prefix);
+    // Bring the routes of one prefix up to date after the seeds or the policy
+    // of AS index `node` changed; returns the number of ASes re-evaluated
+    size_t updatePrefix(PrefixRIB& rib, uint32_t node);
 
 public:
-    auto get(const uint32_t asn) { return _node_map.at(asn); };
+    // Returns the node for `asn`. Throws std::out_of_range if it does not exist.
+    // The pointer is invalidated when new nodes are added.
+    ASNode* get(const uint32_t asn) { return &_nodes[_index.at(asn)]; };
+    const ASNode* get(const uint32_t asn) const { return &_nodes[_index.at(asn)]; };
+
+    size_t size() const { return _nodes.size(); }
+
+    // Neighbor ASNs of `asn` (empty if the AS is unknown)
+    std::vector<uint32_t> providersOf(uint32_t asn) const;
+    std::vector<uint32_t> customersOf(uint32_t asn) const;
+    std::vector<uint32_t> peersOf(uint32_t asn) const;
 
     void addNode(const uint32_t asn);
     void addProvider(const uint32_t provider_asn, const uint32_t customer_asn);
     void addPeer(const uint32_t node1_asn, const uint32_t node2_asn);
 
-    void buildGraphFromFile(const std::string& filename);
+    // Load a CAIDA relationship file (plain, .gz or .bz2). Returns false if the
+    // file could not be opened or decompressed; malformed rows are only warned about.
+    bool buildGraphFromFile(const std::string& filename);
+
+    // Binary snapshot of the fully built graph (ASN table, CSR adjacency and
+    // propagation ranks), see GraphSnapshot.h. Loading replaces the current
+    // topology and skips parsing, cycle detection and ranking entirely.
+    // Both return false (after printing an error) on failure.
+    bool writeSnapshot(const std::string& filename);
+    bool loadSnapshot(const std::string& filename);
 
+    // True if the provider -> customer edges contain a cycle
     bool hasProviderCycle();
 
+    // ASNs (sorted) of a strongly connected component that forms a provider
+    // cycle, or empty if the graph is acyclic
+    const std::vector<uint32_t>& providerCycle();
+
     // Flatten graph by provider/customer relation. Returns a vector of vectors of ASNs
     // where index 0 contains ASes with no customers, index 1 contains their providers, etc.
-    // Also assigns `_propagation_rank` on each `ASNode`.
+    // Also assigns `_propagation_rank` on each `ASNode`. Throws std::runtime_error
+    // naming the offending ASes if there is a provider cycle.
     std::vector<std::vector<uint32_t>> flattenByProviders();
 
-    // Seed an announcement directly into the local RIB of the AS `asn`.
-    // This will call the AS's Policy `receiveAnnouncement` and then
-    // `processAnnouncements` so the announcement becomes the active RIB entry.
+    // Prefix IDs used by Announcement::prefix_id and the local RIBs.
+    // internPrefix returns PrefixTable::kInvalid if `prefix` is not a valid
+    // CIDR; prefixId also returns it for prefixes that were never interned.
+    uint32_t internPrefix(std::string_view prefix);
+    uint32_t prefixId(std::string_view prefix) const;
+    const PrefixTable& prefixes() const { return _prefixes; }
+
+    // Seed an announcement directly into the local RIB of the AS `asn`. It
+    // passes through the AS's Policy import filter and replaces the current
+    // route only if it is better (see BGP::better).
     void seedAnnouncement(uint32_t asn, const Announcement& ann);
     // Propagate all announcements through the graph following the
     // three-phase procedure: up, across (peers one hop), then down.
     void propagateAnnouncements();
+    const PropagationStats& propagationStats() const { return _stats; }
+
+    // Incremental updates. After propagateAnnouncements() these leave the RIBs
+    // as a full propagation of the new seeds would, but only re-evaluate the
+    // ASes of the affected prefixes whose inputs changed; each returns how
+    // many ASes that was. Before propagation they just edit the seeds. Adding
+    // a seed with seedAnnouncement() after propagation, or editing the
+    // topology, is not tracked: propagate again before the next update.
+    size_t announce(uint32_t asn, const Announcement& ann);
+    // Remove every seed of `prefix` (a prefix ID) at `asn`; returns 0 if there was none
+    size_t withdraw(uint32_t asn, uint32_t prefix);
+    // Switch `asn` to ROV (deploy) or plain BGP and update the prefixes that
+    // have ROV-invalid seeds
+    size_t updateROV(uint32_t asn, bool deploy);
+
+    // Both modes select the same routes; Streaming (the default) holds at most
+    // one pending offer per AS instead of one per incoming edge.
+    void setReceiveMode(ReceiveMode mode) { _receive_mode = mode; }
+    ReceiveMode receiveMode() const { return _receive_mode; }
+
+    // Worker threads for propagateAnnouncements (1 = serial, 0 = one per
+    // core). Parallel runs always reduce offers per AS (the receive mode only
+    // applies to serial runs) and produce the same RIBs as a serial run.
+    void setThreads(unsigned threads) { _threads = threads; }
+    unsigned threads() const { return _threads; }
+
+    // Split the prefixes into `shards` groups propagated concurrently, each
+    // on its own thread with its own working state (1 = off, 0 = one per
+    // core). Prefixes never interact, so this needs no locking and the RIBs
+    // are the same as a serial run. Takes precedence over setThreads().
+    void setPrefixShards(unsigned shards) { _prefix_shards = shards; }
+    unsigned prefixShards() const { return _prefix_shards; }
+
+    // Prefixes seeded at the same ASes with the same flags and paths end up
+    // with the same routes, so propagation runs once per such group and the
+    // other members read the first one's RIB (getRoute, dumpRIBsToCSV and
+    // the prefix lookups all see the expanded result). On by default.
+    void setSharePrefixes(bool share) { _share_prefixes = share; }
+
+    // The route AS `asn` holds for `prefix` (a prefix ID), with its full AS
+    // path, or nothing if the AS is unknown or has no route
+    std::optional<Announcement> getRoute(uint32_t asn, uint32_t prefix) const;
 
     // Dump the current AS graph local RIBs to CSV with columns:
     // "asn","prefix","as path"
     // "as path" will contain the stored AS-path for the prefix at that AS,
     // ASNs separated by spaces (e.g. "1 2 3").
-    void dumpRIBsToCSV(const std::string& filename) const;
+    // Rows are grouped by ascending ASN; see RIBDumpOptions for the rest.
+    void dumpRIBsToCSV(const std::string& filename, const RIBDumpOptions& options = {}) const;
+    // The same rows as a columnar binary file with an (ASN, prefix) index for
+    // point and range lookups without parsing the CSV (format and reader in
+    // RIBFile.h). `options.threads` is not used.
+    bool writeRIBFile(const std::string& filename, const RIBDumpOptions& options = {}) const;
+    // Feed the routes selected by `options` to every sink in one pass, in the
+    // order of dumpRIBsToCSV (see RIBSinks.h). Returns false if a sink failed.
+    bool visitRIBs(const RIBDumpOptions& options, const std::vector<RIBSink*>& sinks) const;
 
     // Mark an ASN as deploying ROV (replace its Policy with an ROV instance)
     void setROV(uint32_t asn);
 
+    // Propagate the seeds of `prefix` into `out` (replacing its contents) as if
+    // exactly the AS indices with a nonzero `rov` entry deployed ROV and every
+    // other AS ran plain BGP. The graph's own RIBs and policies are not used or
+    // changed, so concurrent calls with their own `out` and `scratch` are safe
+    // once the ranks are computed (hasProviderCycle() returned false).
+    void propagateWithROV(uint32_t prefix, const std::vector<uint8_t>& rov, PrefixRIB& out,
+                          PropagationScratch& scratch) const;
+    // AS index <-> ASN, for callers that work on dense per-AS arrays
+    uint32_t indexOf(uint32_t asn) const { return _index.at(asn); }
+    // Like indexOf(), but returns false instead of throwing for an unknown ASN
+    bool findIndex(uint32_t asn, uint32_t& index) const {
+        auto it = _index.find(asn);
+        if (it == _index.end()) return false;
+        index = it->second;
+        return true;
+    }
+    uint32_t asnAt(uint32_t index) const { return _nodes[index]._asn; }
+    // Seeds of `prefix` (a prefix ID) in seeding order
+    const std::vector<SeedRoute>& seedsOf(uint32_t prefix) const;
+
+    // Longest-prefix match on the RIBs, e.g. to see where traffic to a
+    // subprefix-hijacked address goes. propagateAnnouncements() indexes every
+    // interned prefix; call buildPrefixIndex() after interning more.
+    // routeFor() returns the ID of the most specific prefix covering `address`
+    // that AS `asn` has a route for, or PrefixTable::kInvalid; routesFor()
+    // does the same for a batch of addresses.
+    void buildPrefixIndex() { _prefix_index.build(_prefixes); }
+    const PrefixIndex& prefixIndex() const { return _prefix_index; }
+    uint32_t routeFor(uint32_t asn, const Prefix& address) const;
+    // routeFor() by AS index, also returning the matched route in `route`
+    uint32_t routeAt(uint32_t node, const Prefix& address, RouteEntry& route) const;
+    void routesFor(uint32_t asn, const std::vector<Prefix>& addresses, std::vector<uint32_t>& out) const;
+
+    // For sweeps over ROV sets on one loaded graph. resetPolicies() puts every
+    // AS that filters routes back on plain BGP; resetRoutes() drops all routes
+    // but keeps the seeds, which are stored again through the current import
+    // filters. Nodes, edges, ranks and prefix IDs are kept.
+    void resetPolicies();
+    void resetRoutes();
+
     // Load ROV-deploying ASNs from a file with one ASN per line
     void loadROVFromFile(const std::string& filename);
 
+    // Only load the announcements of prefixes in `shard`. Each kept prefix
+    // records its position among all distinct prefixes of the file
+    // (prefixOrdinal), which is its prefix ID in a run without shards.
+    void setPrefixShard(const PrefixShard& shard) { _shard = shard; }
+    const PrefixShard& prefixShard() const { return _shard; }
+    uint32_t prefixOrdinal(uint32_t prefix) const {
+        return prefix < _prefix_ordinals.size() ? _prefix_ordinals[prefix] : prefix;
+    }
+    // Number of routes held over all prefixes (rows of dumpRIBsToCSV)
+    size_t routeCount() const;
+
     // Load announcements from a CSV with header: seed_asn,prefix,rov_invalid
     // Example rows:
     // 1,10.0.0.0/24,False
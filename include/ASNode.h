@@ -9,13 +9,13 @@
 class ASNode {
 public:
     uint32_t _asn;
-    std::vector<uint32_t> _providers;
-    std::vector<uint32_t> _customers;
-    std::vector<uint32_t> _peers;
+    // Dense index of this node in its ASGraph (0..N-1). Neighbor lists live in
+    // the graph's CSR arrays and are addressed by this index.
+    uint32_t _index;
     std::unique_ptr<Policy> policy;
     // Propagation rank used when flattening the provider/customer DAG.
     // Nodes with no customers have rank 0. Higher ranks are further "up" the provider chain.
     int _propagation_rank = -1;
 
-    ASNode(uint32_t asn) : _asn(asn) {}
+    ASNode(uint32_t asn, uint32_t index) : _asn(asn), _index(index) {}
 };
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <string>
 #include <vector>
 #include <cstdint>
 
@@ -12,19 +11,19 @@ enum class Relationship {
 };
 
 struct Announcement {
-    std::string prefix;             // e.g., "8.8.8.0/24"
+    uint32_t prefix_id;             // interned prefix, see PrefixTable (e.g. the ID of "8.8.8.0/24")
     std::vector<uint32_t> as_path;  // AS path as a list of ASNs
     uint32_t next_hop_asn;          // where announcement came from
     Relationship received_from;     // origin, provider, peer, or customer
     bool rov_invalid = false;       // whether ROV marks this announcement invalid
 
     // Constructor for origin announcements
-    Announcement(const std::string& p, uint32_t origin_asn)
-        : prefix(p), as_path(), next_hop_asn(origin_asn), received_from(Relationship::Origin), rov_invalid(false) {
+    Announcement(uint32_t prefix, uint32_t origin_asn)
+        : prefix_id(prefix), as_path(), next_hop_asn(origin_asn), received_from(Relationship::Origin), rov_invalid(false) {
         as_path.push_back(origin_asn); // start AS path with origin
     }
 
     // Constructor for received announcements
-    Announcement(const std::string& p, uint32_t nh, Relationship rel, const std::vector<uint32_t>& path, bool rov=false)
-        : prefix(p), next_hop_asn(nh), received_from(rel), as_path(path), rov_invalid(rov) {}
+    Announcement(uint32_t prefix, uint32_t nh, Relationship rel, const std::vector<uint32_t>& path, bool rov=false)
+        : prefix_id(prefix), as_path(path), next_hop_asn(nh), received_from(rel), rov_invalid(rov) {}
 };
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "ChunkedParse.h"
+#include "PrefixTable.h"
+
+// One data row of an announcements CSV: seed_asn,prefix,rov_invalid
+// `prefix` points into the parsed buffer and is only valid while it is;
+// `parsed_prefix` is its binary form, ready for PrefixTable::intern.
+struct AnnouncementRow {
+    uint32_t seed_asn;
+    std::string_view prefix;
+    Prefix parsed_prefix;
+    bool rov_invalid;
+};
+
+// Parse one row (without its newline). Fields are trimmed; `rov_invalid` is
+// true only for the literal "True". Columns after the third are ignored.
+// Returns false if the row is malformed, including an invalid CIDR prefix.
+bool parseAnnouncementLine(const char* begin, const char* end, AnnouncementRow& out);
+
+// Parse every data row in [begin, end) (the header must already be skipped).
+// Blank lines and lines starting with '#' are skipped; malformed rows are
+// recorded in `report` numbered from `first_line`.
+void parseAnnouncements(const char* begin, const char* end,
+                        std::vector<AnnouncementRow>& rows,
+                        ParseReport& report,
+                        size_t first_line = 1);
@@ -1,20 +1,28 @@
 #pragma once
 #include "Policy.h"
 #include "Announcement.h"
-#include <unordered_map>
-#include <vector>
-#include <string>
+#include "RIBStore.h"
+#include <cstdint>
 
 class BGP : public Policy {
-private:
-    std::unordered_map<std::string, Announcement> local_rib;
-    std::unordered_map<std::string, std::vector<Announcement>> received_queue;
-
 public:
     BGP() = default;
 
-    void receiveAnnouncement(const Announcement& ann) override { received_queue[ann.prefix].push_back(ann); };
-    void processAnnouncements() override;
-    void processAnnouncementsFor(uint32_t my_asn) override;
-    const std::unordered_map<std::string, Announcement>& getLocalRIB() const override { return local_rib; };
+    bool acceptsAnnouncement(bool) const override { return true; }
+    ImportRule importRule() const override { return ImportRule::AcceptAll; }
+
+    // Preference rank stored in RouteEntry::rel: Origin > Customer > Peer >
+    // Provider, all above 0 ("no route")
+    static uint8_t rankOf(Relationship r);
+    static Relationship relationshipOf(uint8_t rel);
+
+    // True if route `a` is strictly preferred to `b`: better relationship, then
+    // shorter AS path, then lower next-hop ASN. Any route beats an empty entry.
+    static bool better(const RouteEntry& a, const RouteEntry& b) {
+        uint8_t ra = a.rel & RouteEntry::kRankMask;
+        uint8_t rb = b.rel & RouteEntry::kRankMask;
+        if (ra != rb) return ra > rb;
+        if (a.len != b.len) return a.len < b.len;
+        return a.next_hop < b.next_hop;
+    }
 };
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Compressed-sparse-row adjacency over dense AS indices 0..N-1.
+// Provider, customer and peer neighbors live in three separate contiguous
+// arrays; the neighbors of node i are targets[offsets[i] .. offsets[i+1]).
+class CSRGraph {
+public:
+    // Contiguous, read-only list of neighbor indices
+    class Range {
+        const uint32_t* _begin = nullptr;
+        const uint32_t* _end = nullptr;
+    public:
+        Range() = default;
+        Range(const uint32_t* b, const uint32_t* e) : _begin(b), _end(e) {}
+        const uint32_t* begin() const { return _begin; }
+        const uint32_t* end() const { return _end; }
+        size_t size() const { return static_cast<size_t>(_end - _begin); }
+        bool empty() const { return _begin == _end; }
+        uint32_t operator[](size_t i) const { return _begin[i]; }
+    };
+
+    enum Kind { Providers = 0, Customers = 1, Peers = 2 };
+
+    // Bulk build from edge lists. `provider_edges` holds (provider, customer)
+    // pairs and `peer_edges` holds unordered peer pairs. Duplicate edges are
+    // removed; neighbor lists end up sorted by index.
+    void build(uint32_t num_nodes,
+               std::vector<std::pair<uint32_t, uint32_t>> provider_edges,
+               std::vector<std::pair<uint32_t, uint32_t>> peer_edges);
+
+    // Install prebuilt rows for one kind (used when loading a snapshot).
+    // `offsets` must have num_nodes + 1 entries.
+    void assign(uint32_t num_nodes, Kind kind, std::vector<uint32_t> offsets, std::vector<uint32_t> targets);
+
+    uint32_t numNodes() const { return _num_nodes; }
+
+    // Nodes added after the arrays were built simply have no neighbors
+    Range neighbors(Kind kind, uint32_t i) const {
+        const std::vector<uint32_t>& offsets = _offsets[kind];
+        if (i + 1 >= offsets.size()) return Range();
+        const uint32_t* base = _targets[kind].data();
+        return Range(base + offsets[i], base + offsets[i + 1]);
+    }
+    Range providers(uint32_t i) const { return neighbors(Providers, i); }
+    Range customers(uint32_t i) const { return neighbors(Customers, i); }
+    Range peers(uint32_t i) const { return neighbors(Peers, i); }
+
+    const std::vector<uint32_t>& offsets(Kind kind) const { return _offsets[kind]; }
+    const std::vector<uint32_t>& targets(Kind kind) const { return _targets[kind]; }
+
+private:
+    uint32_t _num_nodes = 0;
+    std::vector<uint32_t> _offsets[3];
+    std::vector<uint32_t> _targets[3];
+};
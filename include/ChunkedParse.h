@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <future>
+#include <utility>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// Summary of a parse run. Line numbers are 1-based.
+struct ParseReport {
+    size_t lines = 0;                    // lines scanned, including comments/blank lines
+    std::vector<size_t> malformed_lines; // rows that could not be parsed
+};
+
+// Split [begin, end) into at most `parts` non-empty pieces, each ending just
+// after a newline (or at `end`).
+std::vector<std::pair<const char*, const char*>> splitAtLines(const char* begin, const char* end, size_t parts);
+
+// Parse [begin, end) with `parse(b, e, out, report, first_line)` on line-aligned
+// chunks in parallel. Each chunk fills its own buffer; buffers and malformed
+// line numbers are then merged in input order, so the result is identical to a
+// single serial call. `threads` == 0 uses ThreadPool::defaultThreads(); no
+// chunk is made smaller than `min_chunk_bytes`, so small inputs are parsed
+// serially on the calling thread.
+template <typename T, typename ParseFn>
+void parseChunked(const char* begin, const char* end, ParseFn parse,
+                  std::vector<T>& out, ParseReport& report,
+                  size_t first_line = 1, unsigned threads = 0,
+                  size_t min_chunk_bytes = size_t(1) << 20) {
+    const size_t bytes = static_cast<size_t>(end - begin);
+    size_t parts = threads ? threads : ThreadPool::defaultThreads();
+    if (bytes / min_chunk_bytes < parts) parts = bytes / min_chunk_bytes;
+    if (parts <= 1) {
+        parse(begin, end, out, report, first_line);
+        return;
+    }
+
+    auto chunks = splitAtLines(begin, end, parts);
+    std::vector<std::vector<T>> buffers(chunks.size());
+    std::vector<ParseReport> reports(chunks.size());
+    {
+        ThreadPool pool(static_cast<unsigned>(chunks.size()));
+        std::vector<std::future<void>> done;
+        done.reserve(chunks.size());
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            done.push_back(pool.submit([&, c]() {
+                parse(chunks[c].first, chunks[c].second, buffers[c], reports[c], 1);
+            }));
+        }
+        for (auto& f : done) f.get();
+    }
+
+    // Deterministic merge: chunk order == input order
+    size_t total = out.size();
+    for (const auto& b : buffers) total += b.size();
+    out.reserve(total);
+    size_t line_base = first_line - 1;
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        out.insert(out.end(), std::make_move_iterator(buffers[c].begin()), std::make_move_iterator(buffers[c].end()));
+        for (size_t l : reports[c].malformed_lines) report.malformed_lines.push_back(line_base + l);
+        line_base += reports[c].lines;
+        report.lines += reports[c].lines;
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+// True if `filename` ends in ".gz" or ".bz2"
+bool isCompressedPath(const std::string& filename);
+
+// Stream-decompress a .gz or .bz2 file. Decompression runs on a background
+// thread that fills a small bounded queue of blocks, while the calling thread
+// hands the data to `consume` as ranges of whole lines, so decompression and
+// parsing overlap and nothing is written to disk. A final line without a
+// trailing newline is delivered on its own at the end.
+// Prints an error and returns false if the file cannot be opened or is corrupt.
+bool readCompressedLines(const std::string& filename,
+                         const std::function<void(const char* begin, const char* end)>& consume,
+                         size_t block_size = size_t(1) << 20);
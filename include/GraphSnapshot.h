@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// On-disk layout of an ASGraph snapshot (native byte order, 8-byte aligned).
+//
+//   SnapshotHeader
+//   uint32_t asns[num_nodes]                      dense index -> ASN
+//   uint32_t rank_offsets[num_ranks + 1]          nodes of rank r are
+//   uint32_t rank_nodes[num_nodes]                rank_nodes[rank_offsets[r] .. rank_offsets[r+1])
+//   for kind in (providers, customers, peers):
+//     uint32_t offsets[num_nodes + 1]
+//     uint32_t targets[num_edges[kind]]
+//
+// Every array starts on an 8-byte boundary (padding is zero filled). A node's
+// propagation rank is the bucket it sits in; rank_nodes must list every node
+// exactly once.
+// Bump kSnapshotVersion whenever the layout changes; older files are rejected.
+
+constexpr char kSnapshotMagic[8] = {'B', 'G', 'P', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t kSnapshotVersion = 2;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_nodes;
+    uint32_t num_ranks;
+    uint32_t reserved;
+    uint64_t num_edges[3]; // indexed by CSRGraph::Kind
+};
+
+// True if `filename` starts with the snapshot magic (used to tell snapshots
+// apart from text relationship files).
+bool isGraphSnapshot(const std::string& filename);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ASGraph.h"
+#include "RIBStore.h"
+
+// Settings for HijackTrialRunner::run
+struct HijackTrialConfig {
+    std::vector<unsigned> adoption_percents = {10, 20, 30, 40, 50, 60, 70, 80, 90, 100};
+    unsigned trials = 100;  // per adoption level
+    uint64_t seed = 1;
+    unsigned threads = 0;   // 0 = one per core
+};
+
+// Hijack success over the trials of one adoption level
+struct HijackTrialSummary {
+    unsigned adoption_percent = 0;
+    unsigned trials = 0;
+    unsigned adopters = 0;  // ASes deploying ROV in each trial
+    // Of the per-trial success fraction
+    double mean = 0, stddev = 0, min = 0, max = 0;
+};
+
+// Monte Carlo ROV adoption trials over one loaded graph and its seeded
+// announcements. A trial picks a random set of ASes to deploy ROV (every other
+// AS runs plain BGP, whatever policies the graph holds), propagates every
+// prefix that has an ROV-invalid seed, and measures the hijack success: the
+// fraction of ASes, other than the prefix's own seed ASes, whose selected
+// route is ROV invalid. ASes that seed an invalid announcement never adopt.
+//
+// Each trial draws from its own generator seeded from (seed, adoption level,
+// trial number), so results do not depend on the thread count or scheduling.
+class HijackTrialRunner {
+public:
+    // Computes the ranks; throws std::runtime_error if there is a provider cycle
+    explicit HijackTrialRunner(ASGraph& g);
+
+    // Prefixes that have an ROV-invalid seed
+    const std::vector<uint32_t>& hijackedPrefixes() const { return _hijacked; }
+
+    // ROV flags (by AS index) of trial `trial` at `percent` adoption
+    std::vector<uint8_t> adopters(unsigned percent, unsigned trial, uint64_t seed) const;
+
+    // Hijack success with the ASes flagged in `rov` deploying ROV, summed over
+    // all hijacked prefixes; `rib` and `scratch` are working buffers
+    double hijackSuccess(const std::vector<uint8_t>& rov, PrefixRIB& rib, PropagationScratch& scratch) const;
+
+    // All trials of every level in `config`, one summary per level
+    std::vector<HijackTrialSummary> run(const HijackTrialConfig& config) const;
+
+private:
+    const ASGraph& _graph;
+    std::vector<uint32_t> _hijacked;
+    std::vector<uint32_t> _candidates;  // AS indices that may adopt
+};
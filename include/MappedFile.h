@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only view of a whole file. On POSIX systems the file is memory-mapped so
+// parsers can work on the bytes in place; elsewhere it falls back to reading
+// the file into an owned buffer.
+class MappedFile {
+    const char* _data = nullptr;
+    size_t _size = 0;
+    bool _open = false;
+#ifdef _WIN32
+    std::string _buffer;
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map `filename`. Returns false if the file could not be opened or mapped.
+    bool open(const std::string& filename);
+    void close();
+
+    bool isOpen() const { return _open; }
+    const char* data() const { return _data; }
+    size_t size() const { return _size; }
+    const char* begin() const { return _data; }
+    const char* end() const { return _data + _size; }
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+// Upstream for PhaseArena: plain heap memory, counting the blocks taken
+class CountingResource : public std::pmr::memory_resource {
+public:
+    uint64_t allocations() const { return _allocations; }
+    uint64_t bytes() const { return _bytes; }
+
+private:
+    uint64_t _allocations = 0;
+    uint64_t _bytes = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// Bump allocator for the offers of one propagation step, released in bulk by
+// reset(). Memory comes from a buffer kept between steps; a step that
+// outgrows it spills to the heap, and the next reset() grows the buffer to
+// that high-water mark, so a run settles at no heap allocations per step.
+class PhaseArena {
+public:
+    PhaseArena();
+
+    PhaseArena(const PhaseArena&) = delete;
+    PhaseArena& operator=(const PhaseArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &*_arena; }
+
+    // Free everything allocated since the last reset. Containers using
+    // resource() must be destroyed first.
+    void reset();
+
+    size_t capacity() const { return _buffer.size(); }
+    uint64_t resets() const { return _resets; }
+    // Blocks the arena had to take from the heap because the buffer was full
+    uint64_t heapBlocks() const { return _upstream.allocations(); }
+
+private:
+    static constexpr size_t kInitialBytes = 64 << 10;
+
+    std::vector<std::byte> _buffer;
+    CountingResource _upstream;
+    std::optional<std::pmr::monotonic_buffer_resource> _arena;
+    uint64_t _resets = 0;
+    uint64_t _spilled_bytes = 0;  // upstream bytes at the last reset
+};
@@ -1,25 +1,27 @@
 #pragma once
-#include <string>
-#include <unordered_map>
-#include <vector>
-#include <memory>
-#include "Announcement.h"
+#include <cstdint>
+
+// How the propagation engine applies a policy's import filter. The built-in
+// rules are read once per AS per propagation into a per-AS table and checked
+// inline; only Custom policies are asked through acceptsAnnouncement() for
+// every route.
+enum class ImportRule : uint8_t {
+    AcceptAll,       // BGP
+    DropROVInvalid,  // ROV
+    Custom
+};
 
 class Policy {
 public:
     virtual ~Policy() = default;
 
-    // Insert a new announcement into the received queue
-    virtual void receiveAnnouncement(const Announcement& ann) = 0;
-
-    // Process the received announcements and update the local RIB
-    virtual void processAnnouncements() = 0;
-
-    // Process the received announcements and update the local RIB, using
-    // `my_asn` as the ASN of the AS doing the processing. Implementations
-    // should prepend `my_asn` to any stored AS-paths when storing.
-    virtual void processAnnouncementsFor(uint32_t my_asn) = 0;
+    // Import filter, applied whenever the AS receives an announcement
+    // (including seeded ones). Returning false drops the announcement before
+    // route selection. Routes themselves live in the graph's RIB store, see
+    // RIBStore.h.
+    virtual bool acceptsAnnouncement(bool rov_invalid) const = 0;
 
-    // Access the local RIB
-    virtual const std::unordered_map<std::string, Announcement>& getLocalRIB() const = 0;
+    // A new policy whose filter matches a built-in rule should return it, so
+    // propagation never calls acceptsAnnouncement() for it
+    virtual ImportRule importRule() const { return ImportRule::Custom; }
 };
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "PrefixTable.h"
+
+// Longest-prefix-match index over the prefixes of a PrefixTable: one
+// path-compressed binary trie per address family, with nodes only where a
+// prefix ends or two branches split. Prefixes that differ only in host bits
+// share a node. Lookups walk at most one node per stored prefix length on the
+// way to the address, so they are cheap enough to run per AS and per
+// destination.
+class PrefixIndex {
+public:
+    // Index every prefix of `table` (replacing the previous contents)
+    void build(const PrefixTable& table);
+    size_t nodes() const { return _nodes.size(); }
+
+    // IDs of the prefixes that contain `address`, most specific first
+    void matches(const Prefix& address, std::vector<uint32_t>& out) const;
+
+    // Most specific prefix containing `address` for which usable(id) is true,
+    // or PrefixTable::kInvalid. Among prefixes with the same network the
+    // lowest ID wins.
+    template <typename Usable>
+    uint32_t longestMatch(const Prefix& address, Usable&& usable) const {
+        const Bits a = bitsOf(address);
+        uint32_t best = PrefixTable::kInvalid;
+        for (uint32_t n = address.ipv6 ? _root6 : _root4; n != kNone;) {
+            const Node &node = _nodes[n];
+            if (commonLength(a, node.key) < node.len) break;
+            for (uint32_t k = node.ids_begin; k < node.ids_end; ++k) {
+                if (usable(_ids[k])) {
+                    best = _ids[k];
+                    break;
+                }
+            }
+            if (node.len >= address.length) break;
+            n = node.child[bitAt(a, node.len)];
+        }
+        return best;
+    }
+
+    // longestMatch() for addresses[0..n), results in out[0..n)
+    template <typename Usable>
+    void longestMatches(const Prefix* addresses, size_t n, uint32_t* out, Usable&& usable) const {
+        for (size_t k = 0; k < n; ++k) out[k] = longestMatch(addresses[k], usable);
+    }
+
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    // Address bits, most significant first; IPv4 uses the top 32 bits of hi
+    struct Bits {
+        uint64_t hi = 0, lo = 0;
+    };
+    struct Node {
+        Bits key;  // masked to `len` bits
+        uint32_t child[2] = {kNone, kNone};
+        uint32_t ids_begin = 0, ids_end = 0;  // prefixes ending here, in _ids
+        uint8_t len = 0;
+    };
+
+    static Bits bitsOf(const Prefix& p);
+    static Bits masked(Bits b, unsigned len);
+    static unsigned bitAt(const Bits& b, unsigned i) {
+        return i < 64 ? (b.hi >> (63 - i)) & 1 : (b.lo >> (127 - i)) & 1;
+    }
+    // Number of leading bits `a` and `b` share (128 if equal)
+    static unsigned commonLength(const Bits& a, const Bits& b) {
+        if (a.hi != b.hi) return static_cast<unsigned>(__builtin_clzll(a.hi ^ b.hi));
+        if (a.lo != b.lo) return 64 + static_cast<unsigned>(__builtin_clzll(a.lo ^ b.lo));
+        return 128;
+    }
+
+    uint32_t addNode(const Bits& key, unsigned len);
+    void insert(uint32_t root, const Bits& key, unsigned len, uint32_t ids_begin, uint32_t ids_end);
+
+    std::vector<Node> _nodes;
+    std::vector<uint32_t> _ids;  // prefix IDs grouped by node
+    uint32_t _root4 = kNone, _root6 = kNone;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// A CIDR prefix in binary form. IPv4 addresses use the first 4 bytes of
+// `addr`; bytes are in network order. Host bits are kept as written so that
+// prefixes round-trip to the exact text they were parsed from.
+struct Prefix {
+    std::array<uint8_t, 16> addr{};
+    uint8_t length = 0;
+    bool ipv6 = false;
+
+    bool operator==(const Prefix& o) const { return addr == o.addr && length == o.length && ipv6 == o.ipv6; }
+    bool operator!=(const Prefix& o) const { return !(*this == o); }
+};
+
+// 64-bit FNV-1a of a prefix. Shard membership is defined by this value, so it
+// must not depend on the platform (PrefixHash narrows it to size_t).
+uint64_t prefixShardHash(const Prefix& p);
+
+struct PrefixHash {
+    size_t operator()(const Prefix& p) const { return static_cast<size_t>(prefixShardHash(p)); }
+};
+
+// Parse "a.b.c.d/len" or an IPv6 "x:y::z/len". Returns false if `text` is not
+// a valid CIDR prefix.
+bool parsePrefix(std::string_view text, Prefix& out);
+// Parse a single address ("a.b.c.d" or IPv6 text) as a full-length prefix
+bool parseAddress(std::string_view text, Prefix& out);
+
+// Prefix `index` of `count` (1-based) for multi-process runs: a prefix
+// belongs to shard prefixShardHash(p) % count + 1, so every process selects
+// the same subset whatever the order of the input or the host it runs on
+struct PrefixShard {
+    unsigned index = 1;
+    unsigned count = 1;
+
+    bool contains(const Prefix& p) const { return count <= 1 || prefixShardHash(p) % count == index - 1; }
+};
+
+// Parse "i/N" with 1 <= i <= N
+bool parsePrefixShard(std::string_view text, PrefixShard& out);
+
+// Interns prefixes: every distinct prefix is parsed once and gets a dense
+// 32-bit ID (0, 1, 2, ... in first-seen order). The rest of the simulator keys
+// RIBs and announcements by that ID; the text is only needed for output.
+class PrefixTable {
+public:
+    static constexpr uint32_t kInvalid = UINT32_MAX;
+
+    // ID for `text`, adding it if new. Returns kInvalid if it does not parse.
+    uint32_t intern(std::string_view text);
+    // Same, for a prefix that has already been parsed from `text`
+    uint32_t intern(const Prefix& prefix, std::string_view text);
+    // ID for `text` if it has been interned, else kInvalid
+    uint32_t find(std::string_view text) const;
+
+    const Prefix& prefix(uint32_t id) const { return _prefixes[id]; }
+    const std::string& text(uint32_t id) const { return _texts[id]; }
+    size_t size() const { return _prefixes.size(); }
+    // Every ID, ordered by prefix (IPv4 before IPv6, then address, then length)
+    std::vector<uint32_t> sortedIds() const;
+
+private:
+    std::vector<Prefix> _prefixes;     // id -> parsed prefix
+    std::vector<std::string> _texts;   // id -> text as first seen
+    std::unordered_map<Prefix, uint32_t, PrefixHash> _ids;
+};
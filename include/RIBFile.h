@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "MappedFile.h"
+#include "RIBSinks.h"
+
+// On-disk layout of a binary RIB dump (native byte order, 8-byte aligned),
+// written by ASGraph::writeRIBFile. It holds the rows of ribs.csv as columns:
+//
+//   RIBFileHeader
+//   uint64_t prefix_offsets[num_prefixes + 1]   prefix dictionary: the text of
+//   char     prefix_text[prefix_bytes]          code c is prefix_text[prefix_offsets[c] .. [c+1])
+//   uint32_t asns[num_asns]                     ASN column, run-length encoded:
+//   uint64_t asn_rows[num_asns + 1]             asns[i] holds rows asn_rows[i] .. asn_rows[i+1)
+//   uint32_t row_prefix[num_rows]               prefix code per row
+//   uint32_t row_path[num_rows]                 path ID per row
+//   uint64_t path_offsets[num_paths + 1]        path pool: path k is
+//   uint32_t path_asns[path_cells]              path_asns[path_offsets[k] .. [k+1])
+//
+// Rows are in ribs.csv order: ASNs ascending, and within an AS prefix codes
+// ascending (codes follow the CSV's prefix order), so asns and row_prefix
+// together are an (ASN, prefix) index searched by bisection. Every distinct
+// AS path is stored once. Every array starts on an 8-byte boundary (padding
+// is zero filled). Bump kRIBFileVersion whenever the layout changes.
+
+constexpr char kRIBFileMagic[8] = {'B', 'G', 'P', 'R', 'I', 'B', 'S', '\0'};
+constexpr uint32_t kRIBFileVersion = 1;
+
+struct RIBFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_prefixes;
+    uint32_t num_asns;
+    uint32_t reserved;
+    uint64_t num_rows;
+    uint64_t num_paths;
+    uint64_t path_cells;
+    uint64_t prefix_bytes;
+};
+
+// Append one ribs.csv row (`asn,prefix,"(a, b)"` with a newline) to `out`;
+// shared by every writer of the CSV so they stay byte-identical
+void appendRIBRow(std::string& out, uint32_t asn, std::string_view prefix, const uint32_t* path, size_t path_len);
+
+// Sink that writes a binary RIB file of the routes it is given
+// (ASGraph::writeRIBFile). The rows are held until finish() writes the file.
+class RIBFileWriter : public RIBSink {
+public:
+    explicit RIBFileWriter(std::string filename) : _filename(std::move(filename)) {}
+
+    bool begin(const ASGraph& g, const std::vector<uint32_t>& prefixes) override;
+    void route(uint32_t asn, uint32_t slot, const RouteEntry& route, const std::vector<uint32_t>& path) override;
+    bool finish() override;
+
+private:
+    std::string _filename;
+    std::ofstream _out;
+    std::vector<uint64_t> _prefix_offsets;
+    std::string _prefix_text;
+    std::vector<uint32_t> _asns, _row_prefix, _row_path;
+    std::vector<uint64_t> _asn_rows;
+    // Path pool that stores each distinct path once
+    std::vector<uint64_t> _path_offsets;
+    std::vector<uint32_t> _path_cells;
+    std::unordered_map<uint64_t, uint32_t> _path_first;  // path hash -> newest path with it
+    std::vector<uint32_t> _path_chain;                   // path -> older path with the same hash
+
+    uint32_t addPath(const std::vector<uint32_t>& path);
+};
+
+// One route read from a RIBFile
+struct RIBRow {
+    uint32_t asn;
+    uint32_t prefix;          // prefix code, see RIBFile::prefixText
+    const uint32_t* path;     // AS path, first ASN first (points into the file)
+    uint32_t path_len;
+};
+
+// Reader for binary RIB dumps. The file is memory-mapped and only the small
+// ASN and prefix arrays are checked when it is opened, so point and range
+// queries cost a few bisections instead of a scan over every row.
+class RIBFile {
+public:
+    static constexpr uint32_t kNoPrefix = UINT32_MAX;
+
+    // Map `filename`; prints an error and returns false if it is not a RIB file
+    bool open(const std::string& filename);
+    void close();
+
+    uint64_t rows() const { return _header.num_rows; }
+    uint64_t paths() const { return _header.num_paths; }
+    uint32_t asnCount() const { return _header.num_asns; }
+    uint32_t prefixCount() const { return _header.num_prefixes; }
+    std::string_view prefixText(uint32_t code) const;
+    // Code of the prefix written as `text`, or kNoPrefix
+    uint32_t prefixCode(std::string_view text) const;
+
+    // The path AS `asn` holds for prefix `code` into `path` (first ASN
+    // first); false if it has no route
+    bool find(uint32_t asn, uint32_t code, std::vector<uint32_t>& path) const;
+    // Call f(row) for every row of the ASNs in [first_asn, last_asn], in file
+    // order. Returns false (after an error message) if the rows are corrupt.
+    template <typename F>
+    bool forEach(uint32_t first_asn, uint32_t last_asn, F&& f) const;
+
+    // Write the rows as ribs.csv, byte-identical to ASGraph::dumpRIBsToCSV
+    // with the options the file was written with
+    bool writeCSV(const std::string& filename) const;
+
+private:
+    MappedFile _file;
+    std::string _path;
+    RIBFileHeader _header{};
+    const uint64_t* _prefix_offsets = nullptr;
+    const char* _prefix_text = nullptr;
+    const uint32_t* _asns = nullptr;
+    const uint64_t* _asn_rows = nullptr;
+    const uint32_t* _row_prefix = nullptr;
+    const uint32_t* _row_path = nullptr;
+    const uint64_t* _path_offsets = nullptr;
+    const uint32_t* _path_asns = nullptr;
+    std::unordered_map<std::string_view, uint32_t> _codes;
+
+    // Index of `asn` in the ASN column, or the index of the first larger ASN
+    uint32_t asnIndex(uint32_t asn) const;
+    // Row `r` of ASN index `a`; false if the row points outside the file
+    bool row(uint32_t a, uint64_t r, RIBRow& out) const;
+    bool corrupt() const;
+};
+
+template <typename F>
+bool RIBFile::forEach(uint32_t first_asn, uint32_t last_asn, F&& f) const {
+    for (uint32_t a = asnIndex(first_asn); a < _header.num_asns && _asns[a] <= last_asn; ++a) {
+        for (uint64_t r = _asn_rows[a]; r < _asn_rows[a + 1]; ++r) {
+            RIBRow out;
+            if (!row(a, r, out)) return corrupt();
+            f(static_cast<const RIBRow&>(out));
+        }
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ASGraph.h"
+
+// Consumer of one pass over the final RIBs (ASGraph::visitRIBs). Routes come
+// grouped by AS in ascending ASN order, and each AS's routes in the order of
+// the prefixes given to begin(). Several sinks share a pass, so output that is
+// only summarized is never formatted.
+class RIBSink {
+public:
+    virtual ~RIBSink() = default;
+
+    // Start of the pass over the prefix IDs `prefixes`; route() names a
+    // prefix by its position there. Prints an error and returns false if the
+    // sink cannot run (e.g. its file does not open).
+    virtual bool begin(const ASGraph& g, const std::vector<uint32_t>& prefixes) = 0;
+    // The route of AS `asn` for prefixes[slot], with its AS path
+    virtual void route(uint32_t asn, uint32_t slot, const RouteEntry& route, const std::vector<uint32_t>& path) = 0;
+    virtual bool finish() = 0;
+};
+
+// ribs.csv rows, as dumpRIBsToCSV writes them (on one thread)
+class RIBCSVWriter : public RIBSink {
+public:
+    explicit RIBCSVWriter(std::string filename) : _filename(std::move(filename)) {}
+
+    bool begin(const ASGraph& g, const std::vector<uint32_t>& prefixes) override;
+    void route(uint32_t asn, uint32_t slot, const RouteEntry& route, const std::vector<uint32_t>& path) override;
+    bool finish() override;
+
+private:
+    std::string _filename;
+    std::ofstream _out;
+    std::string _buf;
+    std::vector<const std::string*> _texts;  // slot -> prefix text
+};
+
+// Per-prefix summary of the routes: how many ASes picked each origin (the
+// last ASN of the path) and how many hold a path of each length. Written as
+// `prefix,origin,ases` and `prefix,path_length,ases` CSVs, one row per
+// nonzero count, prefixes in pass order.
+class PrefixStatsSink : public RIBSink {
+public:
+    PrefixStatsSink(std::string origins_file, std::string lengths_file)
+        : _origins_file(std::move(origins_file)), _lengths_file(std::move(lengths_file)) {}
+
+    bool begin(const ASGraph& g, const std::vector<uint32_t>& prefixes) override;
+    void route(uint32_t asn, uint32_t slot, const RouteEntry& route, const std::vector<uint32_t>& path) override;
+    bool finish() override;
+
+    // Counts by slot, for callers that use them directly
+    const std::unordered_map<uint32_t, uint64_t>& origins(uint32_t slot) const { return _origins[slot]; }
+    const std::vector<uint64_t>& pathLengths(uint32_t slot) const { return _lengths[slot]; }
+
+private:
+    std::string _origins_file, _lengths_file;
+    std::ofstream _origins_out, _lengths_out;
+    std::vector<const std::string*> _texts;
+    std::vector<std::unordered_map<uint32_t, uint64_t>> _origins;  // slot -> origin ASN -> ASes
+    std::vector<std::vector<uint64_t>> _lengths;                   // slot -> path length -> ASes
+};
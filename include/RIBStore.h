@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// AS paths of one prefix, stored as linked cells. A route learned from a
+// neighbor is the receiver's ASN followed by the neighbor's path, so it is a
+// single new cell pointing at the neighbor's cell instead of a copied vector.
+class PathPool {
+public:
+    static constexpr uint32_t kEnd = UINT32_MAX;  // the empty path
+
+    // Path `asn` followed by the path `rest`
+    uint32_t push(uint32_t asn, uint32_t rest) {
+        _cells.push_back({asn, rest});
+        return static_cast<uint32_t>(_cells.size() - 1);
+    }
+    // Store a full path (first element first)
+    uint32_t append(const std::vector<uint32_t>& path);
+    // Replace `out` with the ASNs of `path`
+    void materialize(uint32_t path, std::vector<uint32_t>& out) const;
+    // The path after the first ASN of `path`
+    uint32_t rest(uint32_t path) const { return _cells[path].rest; }
+
+    size_t size() const { return _cells.size(); }
+    void clear() { _cells.clear(); }
+    // Keep only the first `n` cells
+    void truncate(size_t n) { _cells.resize(n); }
+
+private:
+    struct Cell {
+        uint32_t asn;
+        uint32_t rest;
+    };
+    std::vector<Cell> _cells;
+};
+
+// One AS's route for a prefix. The low bits of `rel` are the preference rank
+// of the relationship the route was learned over (see BGP::rankOf); 0 means
+// no route. Bits 3-4 record the propagation phase that stored the route, which
+// is what incremental updates need to tell what an AS had after each phase.
+// The high bit carries the announcement's rov_invalid flag.
+struct RouteEntry {
+    static constexpr uint8_t kRankMask = 0x07;
+    static constexpr uint8_t kPhaseMask = 0x18;
+    static constexpr uint8_t kPhaseSeed = 0x00;
+    static constexpr uint8_t kPhaseUp = 0x08;
+    static constexpr uint8_t kPhaseAcross = 0x10;
+    static constexpr uint8_t kPhaseDown = 0x18;
+    static constexpr uint8_t kROVInvalid = 0x80;
+
+    uint8_t rel = 0;
+    uint32_t len = 0;        // AS-path length
+    uint32_t next_hop = 0;   // ASN the route was learned from
+    uint32_t path = PathPool::kEnd;
+
+    bool operator==(const RouteEntry& o) const {
+        return rel == o.rel && len == o.len && next_hop == o.next_hop && path == o.path;
+    }
+    bool operator!=(const RouteEntry& o) const { return !(*this == o); }
+};
+
+// An announcement seeded at an AS, kept so a prefix can be recomputed after
+// seeds are added or withdrawn or an AS changes its import policy
+struct SeedRoute {
+    uint32_t node;
+    RouteEntry route;
+};
+
+// Routes as parallel columns, one row per AS (dense) or per stored route
+// (sparse). Propagation works on a dense set of columns so that selection and
+// export are plain scans over contiguous arrays.
+struct RouteColumns {
+    std::vector<uint8_t> rel;
+    std::vector<uint32_t> len;
+    std::vector<uint32_t> next_hop;
+    std::vector<uint32_t> path;
+
+    size_t size() const { return rel.size(); }
+    // `n` empty rows
+    void reset(size_t n);
+    void resize(size_t n);
+    void insert(size_t row, const RouteEntry& e);
+
+    RouteEntry get(size_t row) const { return {rel[row], len[row], next_hop[row], path[row]}; }
+    void put(size_t row, const RouteEntry& e) {
+        rel[row] = e.rel;
+        len[row] = e.len;
+        next_hop[row] = e.next_hop;
+        path[row] = e.path;
+    }
+};
+
+// Route offered to the AS `to` during one propagation step. It is stored only
+// if it beats the receiver's current route when the receiver is processed.
+struct RouteOffer {
+    uint32_t to;
+    uint32_t next_hop;  // ASN of the sender
+    uint32_t len;       // AS-path length once the receiver prepends itself
+    uint32_t path;      // sender's path
+    uint8_t rel;        // rank and flags of the route at the receiver
+};
+
+// The routes every AS holds for one prefix, addressed by dense AS index.
+// Prefixes that reach few ASes are kept sparse (sorted AS indices next to the
+// columns); once more than 1/kDenseFraction of the graph holds a route the
+// table switches to dense columns indexed directly by AS.
+class PrefixRIB {
+public:
+    static constexpr size_t kDenseFraction = 8;
+
+    bool dense() const { return _dense; }
+    size_t count() const { return _count; }
+
+    // Route of AS `node`, if it has one
+    bool find(uint32_t node, RouteEntry& out) const;
+    // Store (or replace) the route of AS `node` in a graph of `num_nodes` ASes
+    void set(uint32_t node, const RouteEntry& e, size_t num_nodes);
+    // Remove the route of AS `node`, if any
+    void erase(uint32_t node);
+    // Call f(node, route) for every stored route, in AS index order
+    template <typename F>
+    void forEach(F&& f) const {
+        if (_dense) {
+            for (size_t i = 0; i < _cols.size(); ++i) {
+                if (_cols.rel[i] != 0) f(static_cast<uint32_t>(i), _cols.get(i));
+            }
+        } else {
+            for (size_t row = 0; row < _members.size(); ++row) f(_members[row], _cols.get(row));
+        }
+    }
+
+    // Seeds in the order they were added, including ones an import filter rejected
+    const std::vector<SeedRoute>& seeds() const { return _seeds; }
+    void addSeed(uint32_t node, const RouteEntry& route) { _seeds.push_back({node, route}); }
+    // Drop the seeds of AS `node`; returns how many there were
+    size_t removeSeeds(uint32_t node);
+    // Drop every route and every path cell not used by a seed, keeping the
+    // buffers for the next propagation
+    void clearRoutes();
+
+    // Fill `work` with one row per AS (num_nodes rows, empty where there is no
+    // route), and take the routes back from it afterwards. gather() may swap
+    // buffers with `work`, whose contents are unspecified after the call.
+    void scatter(RouteColumns& work, size_t num_nodes) const;
+    void gather(RouteColumns& work);
+
+    PathPool& paths() { return _paths; }
+    const PathPool& paths() const { return _paths; }
+
+private:
+    RouteColumns _cols;
+    std::vector<uint32_t> _members;  // sparse only: AS index of each row, ascending
+    size_t _count = 0;
+    bool _dense = false;
+    PathPool _paths;
+    std::vector<SeedRoute> _seeds;
+
+    void makeDense(size_t num_nodes);
+};
@@ -7,11 +7,9 @@ class ROV : public BGP {
 public:
     ROV() = default;
 
-    void receiveAnnouncement(const Announcement& ann) override {
-        if (ann.rov_invalid) {
-            // Drop silently
-            return;
-        }
-        BGP::receiveAnnouncement(ann);
+    bool acceptsAnnouncement(bool rov_invalid) const override {
+        // Drop silently
+        return !rov_invalid;
     }
+    ImportRule importRule() const override { return ImportRule::DropROVInvalid; }
 };
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ChunkedParse.h"
+
+// One row of a CAIDA AS-relationship file: asn1|asn2|rel[|source]
+// `rel` is -1 when asn1 is a provider of asn2 and 0 when they are peers.
+struct ASRelationship {
+    uint32_t asn1;
+    uint32_t asn2;
+    int rel;
+};
+
+// Parse a single line (without its terminating newline). Fields are parsed in
+// place; surrounding whitespace and a trailing '\r' are ignored. Any fields after
+// the relationship (e.g. the serial-2 source column) are ignored.
+// Returns false if the line is malformed.
+bool parseRelationshipLine(const char* begin, const char* end, ASRelationship& out);
+
+// Parse every line in [begin, end), appending well-formed rows to `edges`.
+// Comment lines (starting with '#') and blank lines are skipped. Malformed rows
+// are recorded in `report` numbered from `first_line` and otherwise ignored.
+void parseRelationships(const char* begin, const char* end,
+                        std::vector<ASRelationship>& edges,
+                        ParseReport& report,
+                        size_t first_line = 1);
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "RIBStore.h"
+
+// Route preference packed into one unsigned 64-bit key so that choosing the
+// best of several candidates is a plain minimum: a smaller key is a better
+// route. From the top: 3 bits of inverted relationship rank, 29 bits of AS-path
+// length (saturated; real paths are far shorter) and the 32-bit next-hop ASN,
+// which is exactly the order of BGP::better. Phase and ROV bits of `rel` are
+// not part of the key.
+namespace RouteKey {
+
+constexpr uint64_t kNone = UINT64_MAX;  // no route; loses to every route
+constexpr uint32_t kMaxLen = (1u << 29) - 1;
+
+inline uint64_t pack(uint8_t rel, uint32_t len, uint32_t next_hop) {
+    const uint64_t rank = rel & RouteEntry::kRankMask;
+    const uint64_t l = len < kMaxLen ? len : kMaxLen;
+    return ((7 - rank) << 61) | (l << 32) | next_hop;
+}
+inline uint64_t pack(const RouteEntry& e) {
+    return e.rel == 0 ? kNone : pack(e.rel, e.len, e.next_hop);
+}
+
+// Smallest of keys[0..n) (kNone if n == 0). Uses AVX2 when the CPU has it.
+uint64_t minKey(const uint64_t* keys, size_t n);
+// Portable version, also used for short arrays
+uint64_t minKeyScalar(const uint64_t* keys, size_t n);
+// Whether minKey() runs the vector kernel on this CPU
+bool vectorized();
+
+// Index of the first smallest key, or n if n == 0
+size_t argMin(const uint64_t* keys, size_t n);
+
+}  // namespace RouteKey
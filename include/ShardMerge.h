@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ASGraph.h"
+#include "PrefixTable.h"
+
+// Multi-process runs: each process loads one PrefixShard of the
+// announcements and writes its ribs CSV (sorted by ASN, then by prefix in
+// file order, like any dumpRIBsToCSV output) next to a text manifest:
+//
+//   bgp_simulator shard manifest 1
+//   shard <i>/<N>
+//   ribs <ribs CSV, relative to the manifest's directory>
+//   rows <data rows in the CSV>
+//   prefixes <count>
+//   <ordinal> <prefix>          one line per prefix of the shard
+//
+// A prefix belongs to shard prefixShardHash(prefix) % N + 1 (64-bit on every
+// host), so shards written on different machines fit together. The ordinal is
+// the prefix's position among all prefixes of the announcements file. mergeShards() k-way merges the CSVs of all N shards on
+// (ASN, ordinal), which gives exactly the ribs.csv of a run without shards.
+struct ShardManifest {
+    PrefixShard shard;
+    std::string ribs;  // as written in the manifest
+    uint64_t rows = 0;
+    std::vector<std::pair<uint32_t, std::string>> prefixes;  // (ordinal, text)
+};
+
+// Manifest of `g`'s current RIBs, dumped to `ribs` (a file name in the
+// directory of `path`)
+bool writeShardManifest(const ASGraph& g, const std::string& ribs, const std::string& path);
+bool readShardManifest(const std::string& path, ShardManifest& out);
+
+// Merge the shards listed by `manifests` (all N of one split) into the CSV
+// `out`. Prints an error and returns false if shards are missing, repeated or
+// inconsistent with their manifests.
+bool mergeShards(const std::vector<std::string>& manifests, const std::string& out);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads consuming a FIFO task queue.
+class ThreadPool {
+public:
+    // `threads` == 0 uses defaultThreads()
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(_workers.size()); }
+
+    // Hardware concurrency, or 1 if it cannot be determined
+    static unsigned defaultThreads();
+
+    // Queue `f` for execution; the future yields its result (or exception).
+    template <typename F>
+    auto submit(F&& f) -> std::future<decltype(f())> {
+        using R = decltype(f());
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.emplace_back([task]() { (*task)(); });
+        }
+        _cv.notify_one();
+        return result;
+    }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _stop = false;
+};
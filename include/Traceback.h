@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ASGraph.h"
+#include "PrefixTable.h"
+
+// Where packets from an AS to a destination end up
+enum class TraceOutcome : uint8_t {
+    Legitimate,  // an AS that originated a valid route
+    Attacker,    // an AS that originated an ROV-invalid route
+    Blackhole,   // an AS without a matching route, a forwarding loop, or a next
+                 // hop that is not in the graph
+};
+
+// ASes per outcome for one destination
+struct TraceCounts {
+    uint64_t legitimate = 0, attacker = 0, blackhole = 0;
+};
+
+// Data-plane traceback over the propagated RIBs. Each AS forwards to the
+// next hop of the most specific prefix covering the destination that it has
+// a route for (ASGraph::routeFor), so a hop can switch from a covering prefix
+// to a hijacked subprefix or back. Chains are followed until they reach an
+// origin; every AS on a chain gets the chain's outcome, so each AS is
+// resolved once per destination. Destinations may be addresses or prefixes
+// (a prefix matches the routes that cover all of it).
+class Traceback {
+public:
+    explicit Traceback(const ASGraph& g) : _graph(g) {}
+
+    // Outcome of every AS (by AS index) for `destination`
+    TraceCounts trace(const Prefix& destination, std::vector<TraceOutcome>& outcome) const;
+
+    // Trace every destination, handing destinations to `threads` workers
+    // (0 = one per core). If `outcomes` is given it receives each
+    // destination's per-AS outcomes.
+    std::vector<TraceCounts> run(const std::vector<Prefix>& destinations, unsigned threads,
+                                 std::vector<std::vector<TraceOutcome>>* outcomes = nullptr) const;
+
+private:
+    const ASGraph& _graph;
+};
+
+// Readable name of an outcome ("legitimate", "attacker", "blackhole")
+const char* outcomeName(TraceOutcome outcome);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Fork/join pool for data-parallel loops of very uneven size. Each parallelFor
+// splits its index range into chunks and deals them out to per-worker deques
+// in contiguous blocks; a worker takes chunks from the front of its own deque
+// and, once that is empty, steals from the back of another worker's. The
+// calling thread works as worker 0.
+class WorkStealingPool {
+public:
+    // `threads` == 0 uses ThreadPool::defaultThreads()
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Number of workers, including the calling thread
+    unsigned size() const { return _num_workers; }
+
+    // Call body(begin, end, worker) over [0, n) in chunks of `grain` indices
+    // and return once all of them have run. Ranges no larger than one chunk
+    // run inline on the calling thread.
+    void parallelFor(size_t n, size_t grain, const std::function<void(size_t, size_t, unsigned)>& body);
+
+private:
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<std::pair<size_t, size_t>> chunks;
+    };
+
+    void workerLoop(unsigned id);
+    void runChunks(unsigned id);
+    bool takeChunk(unsigned id, std::pair<size_t, size_t>& chunk);
+
+    unsigned _num_workers;
+    std::unique_ptr<Queue[]> _queues;
+    std::vector<std::thread> _threads;
+
+    // Current job; guarded by _mutex except for _remaining
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    const std::function<void(size_t, size_t, unsigned)>* _body = nullptr;
+    uint64_t _generation = 0;
+    bool _open = false;      // workers may still join the current job
+    unsigned _active = 0;    // background workers inside the current job
+    bool _stop = false;
+    std::atomic<size_t> _remaining{0};  // chunks not yet finished
+};
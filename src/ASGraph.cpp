@@ -9,26 +9,94 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <numeric>
 #include <unordered_map>
-#include <functional>
 #include <cctype>
+#include <cstring>
 #include "../include/BGP.h"
 #include "../include/ROV.h"
+#include "../include/RouteKey.h"
 #include <stdexcept>
+#include "AnnouncementParser.h"
+#include "ChunkedParse.h"
+#include "Decompressor.h"
+#include "MappedFile.h"
+#include "RelationshipParser.h"
+#include "ThreadPool.h"
 
+namespace {
+
+// Import filters the propagation engine is instantiated with; see
+// ASGraph::withImportFilter()
+struct AcceptAllFilter {
+    bool operator()(uint32_t, bool) const { return true; }
+};
+
+struct DropInvalidFilter {
+    const uint8_t* drops;  // AS index -> 1 if it drops ROV-invalid routes
+    bool operator()(uint32_t node, bool rov_invalid) const { return !(rov_invalid && drops[node]); }
+};
+
+}  // namespace
+
+// Print one warning per malformed row (capped so a badly formatted file does
+// not flood the terminal).
+static void reportMalformedRows(const std::string& filename, const char* what, const ParseReport& report) {
+    const size_t max_reported = 10;
+    for (size_t i = 0; i < report.malformed_lines.size() && i < max_reported; ++i) {
+        std::cerr << "Warning: Skipping malformed " << what << " on line "
+                  << report.malformed_lines[i] << " of " << filename << std::endl;
+    }
+    if (report.malformed_lines.size() > max_reported) {
+        std::cerr << "Warning: " << (report.malformed_lines.size() - max_reported)
+                  << " more malformed " << what << " lines in " << filename << std::endl;
+    }
+}
 
 void ASGraph::addNode(const uint32_t asn) {
-    if (_node_map.find(asn) == _node_map.end()) {
-        auto node = std::make_shared<ASNode>(asn);
+    if (_index.find(asn) == _index.end()) {
+        uint32_t idx = static_cast<uint32_t>(_nodes.size());
+        _nodes.emplace_back(asn, idx);
         // Ensure each ASNode has a default BGP policy instance
-        node->policy = std::make_unique<BGP>();
-        _node_map[asn] = node;
+        _nodes.back().policy = std::make_unique<BGP>();
+        _index[asn] = idx;
+
+        // A new node has no edges yet, so it is a rank 0 leaf and the CSR arrays
+        // (which report no neighbors for indices they do not cover) stay valid.
+        if (_ranks_valid && _provider_cycle.empty()) {
+            if (_ranks.empty()) _ranks.emplace_back();
+            _ranks[0].push_back(idx);
+            _nodes.back()._propagation_rank = 0;
+        }
     }
 }
 
 void ASGraph::setROV(uint32_t asn) {
     addNode(asn);
-    _node_map[asn]->policy = std::make_unique<ROV>();
+    _nodes[_index.at(asn)].policy = std::make_unique<ROV>();
+}
+
+void ASGraph::resetPolicies() {
+    for (ASNode &node : _nodes) {
+        if (!node.policy || node.policy->importRule() != ImportRule::AcceptAll) node.policy = std::make_unique<BGP>();
+    }
+}
+
+void ASGraph::resetRoutes() {
+    for (PrefixRIB &rib : _ribs) reseed(rib);
+    _route_owner.clear();
+    _propagated = false;
+}
+
+void ASGraph::reseed(PrefixRIB& rib) {
+    rib.clearRoutes();
+    // Same rule as seedAnnouncement(), in seeding order
+    for (const SeedRoute &seed : rib.seeds()) {
+        if (!_nodes[seed.node].policy->acceptsAnnouncement((seed.route.rel & RouteEntry::kROVInvalid) != 0)) continue;
+        RouteEntry current;
+        if (rib.find(seed.node, current) && !BGP::better(seed.route, current)) continue;
+        rib.set(seed.node, seed.route, _nodes.size());
+    }
 }
 
 void ASGraph::loadROVFromFile(const std::string& filename) {
@@ -58,348 +126,1051 @@ void ASGraph::loadROVFromFile(const std::string& filename) {
 }
 
 void ASGraph::loadAnnouncementsFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+    MappedFile file;
+    if (!file.open(filename)) {
         std::cerr << "Error: Could not open announcements file " << filename << std::endl;
         return;
     }
 
-    std::string line;
-    // Read header (if present)
-    if (!std::getline(file, line)) return;
+    // Skip the header line (if present). If it doesn't contain the expected
+    // columns we still attempt to parse the rows.
+    const char* nl = static_cast<const char*>(std::memchr(file.begin(), '\n', file.size()));
+    if (!nl) return;
 
-    // If header doesn't contain expected columns, we'll still attempt to parse rows
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#') continue;
+    // Rows are parsed in parallel chunks but seeded in file order
+    std::vector<AnnouncementRow> rows;
+    ParseReport report;
+    parseChunked(nl + 1, file.end(), parseAnnouncements, rows, report, 2);
+    reportMalformedRows(filename, "announcement", report);
 
-        std::stringstream ss(line);
-        std::string seed_asn_s, prefix, rov_s;
+    // Prefixes were already parsed by the row parser; interning in file order
+    // keeps prefix IDs deterministic. A shard skips the other prefixes but
+    // still numbers every distinct one, so that shard outputs can be merged
+    // in the order of a run without shards.
+    std::unordered_map<Prefix, uint32_t, PrefixHash> ordinals;
+    for (const AnnouncementRow &row : rows) {
+        uint32_t ordinal = 0;
+        if (_shard.count > 1) {
+            ordinal = ordinals.emplace(row.parsed_prefix, static_cast<uint32_t>(ordinals.size())).first->second;
+            if (!_shard.contains(row.parsed_prefix)) continue;
+        }
+        Announcement ann(_prefixes.intern(row.parsed_prefix, row.prefix), row.seed_asn);
+        if (_shard.count > 1 && ann.prefix_id >= _prefix_ordinals.size()) {
+            _prefix_ordinals.resize(ann.prefix_id + 1);
+            _prefix_ordinals[ann.prefix_id] = ordinal;
+        }
+        ann.rov_invalid = row.rov_invalid;
+        seedAnnouncement(row.seed_asn, ann);
+    }
+}
 
-        // Expect exactly three comma-separated fields: seed_asn,prefix,rov_invalid
-        if (!std::getline(ss, seed_asn_s, ',')) continue;
-        if (!std::getline(ss, prefix, ',')) continue;
-        if (!std::getline(ss, rov_s, ',')) continue;
+uint32_t ASGraph::internPrefix(std::string_view prefix) {
+    return _prefixes.intern(prefix);
+}
 
-        // Trim whitespace and CR/LF from parsed fields
-        auto trim = [](std::string &s) {
-            size_t a = 0;
-            while (a < s.size() && std::isspace((unsigned char)s[a])) ++a;
-            size_t b = s.size();
-            while (b > a && std::isspace((unsigned char)s[b-1])) --b;
-            s = s.substr(a, b - a);
-        };
+uint32_t ASGraph::prefixId(std::string_view prefix) const {
+    return _prefixes.find(prefix);
+}
 
-        trim(seed_asn_s);
-        trim(prefix);
-        trim(rov_s);
+uint32_t ASGraph::recordSeed(uint32_t asn, const Announcement& ann) {
+    addNode(asn);
+    ASNode &node = _nodes[_index.at(asn)];
+    if (!node.policy) {
+        node.policy = std::make_unique<BGP>();
+    }
+    if (ann.prefix_id >= _prefixes.size()) {
+        std::cerr << "Warning: Ignoring announcement with unknown prefix ID " << ann.prefix_id << std::endl;
+        return kNoNode;
+    }
 
-        try {
-            uint32_t seed_asn = static_cast<uint32_t>(std::stoul(seed_asn_s));
-            bool rov = (rov_s == "True");
-            Announcement ann(prefix, seed_asn);
-            ann.rov_invalid = rov;
-            seedAnnouncement(seed_asn, ann);
-        } catch (...) {
-            // ignore malformed lines
+    if (_ribs.size() < _prefixes.size()) _ribs.resize(_prefixes.size());
+    unshare(ann.prefix_id);
+    PrefixRIB &rib = _ribs[ann.prefix_id];
+
+    RouteEntry route;
+    route.rel = BGP::rankOf(ann.received_from) | (ann.rov_invalid ? RouteEntry::kROVInvalid : 0);
+    route.len = static_cast<uint32_t>(ann.as_path.size());
+    route.next_hop = ann.next_hop_asn;
+    route.path = rib.paths().append(ann.as_path);
+    rib.addSeed(node._index, route);
+    return node._index;
+}
+
+void ASGraph::seedAnnouncement(uint32_t asn, const Announcement& ann) {
+    const uint32_t n = recordSeed(asn, ann);
+    if (n == kNoNode) return;
+    if (!_nodes[n].policy->acceptsAnnouncement(ann.rov_invalid)) return;
+
+    PrefixRIB &rib = _ribs[ann.prefix_id];
+    const RouteEntry route = rib.seeds().back().route;
+    RouteEntry current;
+    if (rib.find(n, current) && !BGP::better(route, current)) return;
+    rib.set(n, route, _nodes.size());
+}
+
+size_t ASGraph::announce(uint32_t asn, const Announcement& ann) {
+    const uint32_t n = recordSeed(asn, ann);
+    if (n == kNoNode) return 0;
+    return updatePrefix(_ribs[ann.prefix_id], n);
+}
+
+size_t ASGraph::withdraw(uint32_t asn, uint32_t prefix) {
+    auto it = _index.find(asn);
+    if (it == _index.end() || prefix >= _ribs.size()) return 0;
+    unshare(prefix);
+    if (_ribs[prefix].removeSeeds(it->second) == 0) return 0;
+    return updatePrefix(_ribs[prefix], it->second);
+}
+
+size_t ASGraph::updateROV(uint32_t asn, bool deploy) {
+    addNode(asn);
+    const uint32_t n = _index.at(asn);
+    if (deploy) {
+        _nodes[n].policy = std::make_unique<ROV>();
+    } else {
+        _nodes[n].policy = std::make_unique<BGP>();
+    }
+
+    // The filter only differs on ROV-invalid routes, and those all come from
+    // invalid seeds. Before propagation only the AS's own seeds are affected.
+    // Prefixes that share another one's routes only keep their seeds current.
+    size_t evaluated = 0;
+    for (uint32_t p = 0; p < _ribs.size(); ++p) {
+        PrefixRIB &rib = _ribs[p];
+        if (_propagated && p < _route_owner.size() && _route_owner[p] != p) {
+            reseed(rib);
             continue;
         }
+        bool affected = false;
+        for (const SeedRoute &seed : rib.seeds()) {
+            if (!(seed.route.rel & RouteEntry::kROVInvalid)) continue;
+            if (_propagated || seed.node == n) affected = true;
+        }
+        if (affected) evaluated += updatePrefix(rib, n);
     }
+    return evaluated;
 }
 
-void ASGraph::seedAnnouncement(uint32_t asn, const Announcement& ann) {
-    addNode(asn);
-    auto node = _node_map.at(asn);
-    if (!node->policy) {
-        node->policy = std::make_unique<BGP>();
+RouteEntry ASGraph::seedRoute(const PrefixRIB& rib, uint32_t node) const {
+    // Seeds are applied in order and only replace a strictly worse route
+    RouteEntry best;
+    const Policy &policy = *_nodes[node].policy;
+    for (const SeedRoute &seed : rib.seeds()) {
+        if (seed.node != node || !policy.acceptsAnnouncement((seed.route.rel & RouteEntry::kROVInvalid) != 0)) continue;
+        if (BGP::better(seed.route, best)) best = seed.route;
     }
+    return best;
+}
+
+std::optional<Announcement> ASGraph::getRoute(uint32_t asn, uint32_t prefix) const {
+    auto it = _index.find(asn);
+    if (it == _index.end() || prefix >= _ribs.size()) return std::nullopt;
 
-    node->policy->receiveAnnouncement(ann);
-    node->policy->processAnnouncements();
+    const PrefixRIB &rib = routesOf(prefix);
+    RouteEntry route;
+    if (!rib.find(it->second, route)) return std::nullopt;
+    Announcement ann(prefix, route.next_hop, BGP::relationshipOf(route.rel), {},
+                     (route.rel & RouteEntry::kROVInvalid) != 0);
+    rib.paths().materialize(route.path, ann.as_path);
+    return ann;
 }
 
 // Directed cycle detection on provider -> customer edges.
 // Returns true if a cycle exists.
 bool ASGraph::hasProviderCycle() {
-    enum Color { WHITE = 0, GRAY = 1, BLACK = 2 };
-
-    std::unordered_map<uint32_t, int> color;
-    color.reserve(_node_map.size());
-    for (const auto &p : _node_map) {
-        color[p.first] = WHITE;
-    }
-
-    std::function<bool(uint32_t)> dfs = [&](uint32_t u) -> bool {
-        color[u] = GRAY;
-        auto it = _node_map.find(u);
-        if (it != _node_map.end()) {
-            for (uint32_t v : it->second->_customers) {
-                if (color[v] == GRAY) {
-                    // back-edge found -> cycle
-                    return true;
-                } else if (color[v] == WHITE) {
-                    if (dfs(v)) return true;
+    computeRanks();
+    return !_provider_cycle.empty();
+}
+
+const std::vector<uint32_t>& ASGraph::providerCycle() {
+    computeRanks();
+    return _provider_cycle;
+}
+
+// Single iterative pass over customer -> provider edges (Kahn's algorithm).
+// A node is ranked once all of its customers are, with rank = 1 + the highest
+// customer rank, so leaves are rank 0. Nodes that never become ready sit on or
+// above a provider cycle.
+void ASGraph::computeRanks() {
+    if (_ranks_valid) return;
+
+    const CSRGraph &csr = adjacency();
+    const uint32_t n = static_cast<uint32_t>(_nodes.size());
+    std::vector<uint32_t> pending(n);  // customers not yet ranked
+    std::vector<int> rank(n, 0);
+    std::vector<uint32_t> ready;
+    ready.reserve(n);
+
+    for (uint32_t i = 0; i < n; ++i) {
+        pending[i] = static_cast<uint32_t>(csr.customers(i).size());
+        if (pending[i] == 0) ready.push_back(i);
+    }
+
+    int maxrank = 0;
+    for (size_t head = 0; head < ready.size(); ++head) {
+        uint32_t u = ready[head];
+        if (rank[u] > maxrank) maxrank = rank[u];
+        for (uint32_t p : csr.providers(u)) {
+            if (rank[u] + 1 > rank[p]) rank[p] = rank[u] + 1;
+            if (--pending[p] == 0) ready.push_back(p);
+        }
+    }
+
+    _ranks.clear();
+    _provider_cycle.clear();
+    if (ready.size() < n) {
+        std::vector<uint32_t> remaining;
+        for (uint32_t i = 0; i < n; ++i) {
+            if (pending[i] != 0) remaining.push_back(i);
+        }
+        _provider_cycle = findCycleComponent(remaining);
+        _ranks_valid = true;
+        return;
+    }
+
+    _ranks.assign(n == 0 ? 0 : maxrank + 1, {});
+    for (uint32_t i = 0; i < n; ++i) {
+        _nodes[i]._propagation_rank = rank[i];
+        _ranks[rank[i]].push_back(i);
+    }
+    _ranks_valid = true;
+}
+
+// Iterative Tarjan SCC over the customer edges of the nodes Kahn's pass could
+// not rank. Returns the ASNs of the first component that is an actual cycle
+// (more than one node, or a node that is its own customer).
+std::vector<uint32_t> ASGraph::findCycleComponent(const std::vector<uint32_t>& remaining) const {
+    const CSRGraph &csr = adjacency();
+    const uint32_t unvisited = UINT32_MAX;
+    std::vector<uint32_t> order(_nodes.size(), unvisited), low(_nodes.size(), 0);
+    std::vector<char> in_scope(_nodes.size(), 0), on_stack(_nodes.size(), 0);
+    for (uint32_t i : remaining) in_scope[i] = 1;
+
+    std::vector<uint32_t> stack;
+    std::vector<std::pair<uint32_t, uint32_t>> frames; // (node, next customer offset)
+    uint32_t counter = 0;
+
+    for (uint32_t root : remaining) {
+        if (order[root] != unvisited) continue;
+        frames.emplace_back(root, 0);
+        order[root] = low[root] = counter++;
+        stack.push_back(root);
+        on_stack[root] = 1;
+
+        while (!frames.empty()) {
+            uint32_t u = frames.back().first;
+            auto customers = csr.customers(u);
+            uint32_t &next = frames.back().second;
+            if (next < customers.size()) {
+                uint32_t v = customers[next++];
+                if (!in_scope[v]) continue;
+                if (order[v] == unvisited) {
+                    order[v] = low[v] = counter++;
+                    stack.push_back(v);
+                    on_stack[v] = 1;
+                    frames.emplace_back(v, 0);
+                } else if (on_stack[v] && order[v] < low[u]) {
+                    low[u] = order[v];
                 }
+                continue;
             }
-        }
-        color[u] = BLACK;
-        return false;
-    };
 
-    for (const auto &p : _node_map) {
-        uint32_t asn = p.first;
-        if (color[asn] == WHITE) {
-            if (dfs(asn)) return true;
+            frames.pop_back();
+            if (!frames.empty()) {
+                uint32_t parent = frames.back().first;
+                if (low[u] < low[parent]) low[parent] = low[u];
+            }
+            if (low[u] != order[u]) continue;
+
+            // u is the root of a component
+            std::vector<uint32_t> component;
+            uint32_t w;
+            do {
+                w = stack.back();
+                stack.pop_back();
+                on_stack[w] = 0;
+                component.push_back(_nodes[w]._asn);
+            } while (w != u);
+
+            bool self_loop = false;
+            for (uint32_t c : customers) self_loop = self_loop || c == u;
+            if (component.size() > 1 || self_loop) {
+                std::sort(component.begin(), component.end());
+                return component;
+            }
         }
     }
-    return false;
+    return {};
 }
 
 void ASGraph::addProvider(const uint32_t provider_asn, const uint32_t customer_asn) {
     addNode(provider_asn);
     addNode(customer_asn);
 
-    _node_map[provider_asn]->_customers.push_back(customer_asn);
-    _node_map[customer_asn]->_providers.push_back(provider_asn);
+    materializeEdges();
+    _provider_edges.emplace_back(_index[provider_asn], _index[customer_asn]);
+    _csr_dirty = true;
+    _ranks_valid = false;
+    _propagated = false;
 }
 
 void ASGraph::addPeer(const uint32_t node1_asn, const uint32_t node2_asn) {
     addNode(node1_asn);
     addNode(node2_asn);
-    
-    _node_map[node1_asn]->_peers.push_back(node2_asn);
-    _node_map[node2_asn]->_peers.push_back(node1_asn);
+
+    materializeEdges();
+    _peer_edges.emplace_back(_index[node1_asn], _index[node2_asn]);
+    _csr_dirty = true;
+    _ranks_valid = false;
+    _propagated = false;
 }
 
-void ASGraph::buildGraphFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
-        return;
+const CSRGraph& ASGraph::adjacency() const {
+    if (_csr_dirty) {
+        _csr.build(static_cast<uint32_t>(_nodes.size()), _provider_edges, _peer_edges);
+        _csr_dirty = false;
     }
+    return _csr;
+}
 
-    std::string line;
-    // Read the file line by line
-    while (std::getline(file, line)) {
-        // Skip comments and empty lines
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
+void ASGraph::materializeEdges() {
+    if (!_edges_from_csr) return;
+    _edges_from_csr = false;
 
-        std::stringstream ss(line);
-        std::string segment;
-        uint32_t node1_asn, node2_asn;
-        int relationship;
-
-        // 1. Get node1 ASN
-        std::getline(ss, segment, '|');
-        // trim
-        size_t s1 = 0;
-        while (s1 < segment.size() && std::isspace((unsigned char)segment[s1])) ++s1;
-        size_t e1 = segment.size();
-        while (e1 > s1 && std::isspace((unsigned char)segment[e1-1])) --e1;
-        node1_asn = std::stoul(segment.substr(s1, e1 - s1));
-
-        // 2. Get node2 ASN
-        std::getline(ss, segment, '|');
-        size_t s2 = 0;
-        while (s2 < segment.size() && std::isspace((unsigned char)segment[s2])) ++s2;
-        size_t e2 = segment.size();
-        while (e2 > s2 && std::isspace((unsigned char)segment[e2-1])) --e2;
-        node2_asn = std::stoul(segment.substr(s2, e2 - s2));
-
-        // 3. Get relationship type
-        std::getline(ss, segment, '|');
-        size_t s3 = 0;
-        while (s3 < segment.size() && std::isspace((unsigned char)segment[s3])) ++s3;
-        size_t e3 = segment.size();
-        while (e3 > s3 && std::isspace((unsigned char)segment[e3-1])) --e3;
-        relationship = std::stoi(segment.substr(s3, e3 - s3));
-
-        // Process the relationship
-        if (relationship == -1) {
-            // node1 is provider, node2 is customer
-            addProvider(node1_asn, node2_asn);
-        } 
-        else if (relationship == 0) {
-            // node1 and node2 are peers
-            addPeer(node1_asn, node2_asn);
+    // Recover the edge lists from the snapshot's CSR rows so the arrays can be rebuilt
+    for (uint32_t u = 0; u < _csr.numNodes(); ++u) {
+        for (uint32_t c : _csr.customers(u)) _provider_edges.emplace_back(u, c);
+        for (uint32_t p : _csr.peers(u)) {
+            if (u < p) _peer_edges.emplace_back(u, p);
         }
     }
 }
 
-std::vector<std::vector<uint32_t>> ASGraph::flattenByProviders() {
-    if (hasProviderCycle()) {
-        throw std::runtime_error("Provider cycle detected in relationships");
-    }
+std::vector<uint32_t> ASGraph::toASNs(CSRGraph::Range r) const {
+    std::vector<uint32_t> asns;
+    asns.reserve(r.size());
+    for (uint32_t i : r) asns.push_back(_nodes[i]._asn);
+    return asns;
+}
 
-    std::unordered_map<uint32_t, int> memo; // asn -> rank
-    memo.reserve(_node_map.size());
+std::vector<uint32_t> ASGraph::providersOf(uint32_t asn) const {
+    auto it = _index.find(asn);
+    if (it == _index.end()) return {};
+    return toASNs(adjacency().providers(it->second));
+}
 
-    std::function<int(uint32_t)> dfs_rank = [&](uint32_t asn) -> int {
-        auto itm = memo.find(asn);
-        if (itm != memo.end()) return itm->second;
+std::vector<uint32_t> ASGraph::customersOf(uint32_t asn) const {
+    auto it = _index.find(asn);
+    if (it == _index.end()) return {};
+    return toASNs(adjacency().customers(it->second));
+}
 
-        auto it = _node_map.find(asn);
-        if (it == _node_map.end()) {
-            // Unknown node, treat as rank 0
-            memo[asn] = 0;
-            return 0;
-        }
+std::vector<uint32_t> ASGraph::peersOf(uint32_t asn) const {
+    auto it = _index.find(asn);
+    if (it == _index.end()) return {};
+    return toASNs(adjacency().peers(it->second));
+}
 
-        auto node = it->second;
-        if (node->_customers.empty()) {
-            memo[asn] = 0;
-            node->_propagation_rank = 0;
-            return 0;
-        }
+bool ASGraph::buildGraphFromFile(const std::string& filename) {
+    std::vector<ASRelationship> edges;
+    ParseReport report;
 
-        int mx = 0;
-        for (uint32_t c : node->_customers) {
-            int r = dfs_rank(c);
-            if (r + 1 > mx) mx = r + 1;
+    if (isCompressedPath(filename)) {
+        // .gz / .bz2: parse blocks of whole lines as they are decompressed
+        bool ok = readCompressedLines(filename, [&](const char* b, const char* e) {
+            parseRelationships(b, e, edges, report, report.lines + 1);
+        });
+        if (!ok) return false;
+    } else {
+        MappedFile file;
+        if (!file.open(filename)) {
+            std::cerr << "Error: Could not open file " << filename << std::endl;
+            return false;
         }
-        memo[asn] = mx;
-        node->_propagation_rank = mx;
-        return mx;
-    };
 
-    int maxrank = 0;
-    for (const auto &p : _node_map) {
-        int r = dfs_rank(p.first);
-        if (r > maxrank) maxrank = r;
+        // Parse rows in place from the mapping (in parallel chunks for large
+        // files)
+        parseChunked(file.begin(), file.end(), parseRelationships, edges, report);
+    }
+    reportMalformedRows(filename, "relationship", report);
+
+    // Bulk build: register every ASN in sorted order so a fresh graph gets
+    // dense indices that follow ASN order, then map the edges to indices.
+    materializeEdges();
+    std::vector<uint32_t> asns;
+    asns.reserve(edges.size() * 2);
+    for (const ASRelationship &e : edges) {
+        if (e.rel != -1 && e.rel != 0) continue;
+        asns.push_back(e.asn1);
+        asns.push_back(e.asn2);
     }
+    std::sort(asns.begin(), asns.end());
+    asns.erase(std::unique(asns.begin(), asns.end()), asns.end());
+    _nodes.reserve(_nodes.size() + asns.size());
+    _index.reserve(_index.size() + asns.size());
+    for (uint32_t asn : asns) addNode(asn);
+
+    for (const ASRelationship &e : edges) {
+        if (e.rel == -1) {
+            // asn1 is provider, asn2 is customer
+            _provider_edges.emplace_back(_index[e.asn1], _index[e.asn2]);
+        }
+        else if (e.rel == 0) {
+            // asn1 and asn2 are peers
+            _peer_edges.emplace_back(_index[e.asn1], _index[e.asn2]);
+        }
+    }
+    _csr_dirty = true;
+    _ranks_valid = false;
+    _propagated = false;
+    adjacency();
+    return true;
+}
 
-    std::vector<std::vector<uint32_t>> ranks(maxrank + 1);
-    for (const auto &p : _node_map) {
-        int r = memo[p.first];
-        ranks[r].push_back(p.first);
+const std::vector<std::vector<uint32_t>>& ASGraph::rankIndices() {
+    computeRanks();
+    if (!_provider_cycle.empty()) {
+        std::ostringstream msg;
+        msg << "Provider cycle detected in relationships among ASes";
+        for (size_t i = 0; i < _provider_cycle.size() && i < 20; ++i) msg << ' ' << _provider_cycle[i];
+        if (_provider_cycle.size() > 20) msg << " ... (" << _provider_cycle.size() << " ASes)";
+        throw std::runtime_error(msg.str());
     }
+    return _ranks;
+}
 
+std::vector<std::vector<uint32_t>> ASGraph::flattenByProviders() {
+    auto ranks = rankIndices();
+    for (auto &rank : ranks) {
+        for (uint32_t &i : rank) i = _nodes[i]._asn;
+    }
     return ranks;
 }
 
 void ASGraph::propagateAnnouncements() {
     // Step 0: prepare ranks
-    auto ranks = flattenByProviders();
-    if (ranks.empty() && _node_map.empty()) return;
-    int maxrank = (int)ranks.size() - 1;
-
-    // UPWARD propagation: from rank 0 up to maxrank
-    for (int r = 0; r <= maxrank; ++r) {
-        // Send: for each AS in rank r, send its stored local RIB to its providers
-        for (uint32_t asn : ranks[r]) {
-            auto node_it = _node_map.find(asn);
-            if (node_it == _node_map.end()) continue;
-            auto node = node_it->second;
-            const auto &rib = node->policy->getLocalRIB();
-            for (const auto &kv : rib) {
-                const std::string &prefix = kv.first;
-                const Announcement &stored = kv.second;
-                for (uint32_t prov : node->_providers) {
-                    // sent announcement: next_hop is the sender (asn), relationship is Customer
-                    Announcement sent(prefix, asn, Relationship::Customer, stored.as_path, stored.rov_invalid);
-                    _node_map[prov]->policy->receiveAnnouncement(sent);
+    _stats = PropagationStats{};
+    const auto &ranks = rankIndices();
+    _propagated = true;
+    _prefix_index.build(_prefixes);
+    if (ranks.empty()) return;
+
+    refreshImportRules();
+    std::vector<uint32_t> todo;  // prefixes with routes to propagate
+    for (uint32_t p = 0; p < _ribs.size(); ++p) {
+        if (_ribs[p].count() != 0) todo.push_back(p);
+    }
+    groupBySeeds(todo);
+
+    unsigned shards = _prefix_shards ? _prefix_shards : ThreadPool::defaultThreads();
+    shards = static_cast<unsigned>(std::min<size_t>(shards, todo.size()));
+    if (shards > 1) {
+        // Prefix k goes to shard k % shards. A shard only touches the RIBs of
+        // its own prefixes and its own scratch; the graph is shared read-only.
+        std::vector<PropagationScratch> scratch(shards);
+        ThreadPool pool(shards);
+        std::vector<std::future<void>> done;
+        for (unsigned s = 0; s < shards; ++s) {
+            done.push_back(pool.submit([&, s]() {
+                for (size_t k = s; k < todo.size(); k += shards) {
+                    PrefixRIB &rib = _ribs[todo[k]];
+                    withImportFilter(rib, [&](const auto &accepts) { propagatePrefix(rib, scratch[s], accepts); });
                 }
-            }
+            }));
         }
+        for (auto &f : done) f.get();
 
-        // Process: process the next rank (r+1) so providers incorporate received announcements
-        if (r + 1 <= maxrank) {
-            for (uint32_t asn : ranks[r + 1]) {
-                auto node_it = _node_map.find(asn);
-                if (node_it == _node_map.end()) continue;
-                node_it->second->policy->processAnnouncementsFor(asn);
-            }
+        for (PropagationScratch &sc : scratch) {
+            sc.stats.arena_heap_blocks = sc.arena.heapBlocks();
+            sc.stats.arena_bytes = sc.arena.capacity();
+            _stats.merge(sc.stats);
         }
+        _stats.shards = shards;
+        return;
     }
 
-    // ACROSS (peers): send one hop across peers from all ASes, then process all
-    // Send phase
-    for (const auto &p : _node_map) {
-        uint32_t asn = p.first;
-        auto node = p.second;
-        const auto &rib = node->policy->getLocalRIB();
-        for (const auto &kv : rib) {
-            const std::string &prefix = kv.first;
-            const Announcement &stored = kv.second;
-            for (uint32_t peer : node->_peers) {
-                Announcement sent(prefix, asn, Relationship::Peer, stored.as_path, stored.rov_invalid);
-                _node_map[peer]->policy->receiveAnnouncement(sent);
+    std::unique_ptr<WorkStealingPool> pool;
+    if (_threads != 1) pool = std::make_unique<WorkStealingPool>(_threads);
+
+    // Prefixes propagate independently, so run them one at a time on a dense
+    // working copy of their routes; the buffers are reused across prefixes.
+    PropagationScratch scratch;
+    for (uint32_t p : todo) {
+        PrefixRIB &rib = _ribs[p];
+        withImportFilter(rib, [&](const auto &accepts) {
+            if (pool && pool->size() > 1) {
+                propagatePrefixParallel(rib, scratch, *pool, accepts);
+            } else {
+                propagatePrefix(rib, scratch, accepts);
             }
+        });
+    }
+    scratch.stats.arena_heap_blocks = scratch.arena.heapBlocks();
+    scratch.stats.arena_bytes = scratch.arena.capacity();
+    _stats.merge(scratch.stats);
+}
+
+void ASGraph::groupBySeeds(std::vector<uint32_t>& todo) {
+    _route_owner.resize(_ribs.size());
+    for (uint32_t p = 0; p < _ribs.size(); ++p) _route_owner[p] = p;
+    if (!_share_prefixes) return;
+
+    // The signature lists each seed's AS, route and AS path. Seeds of
+    // different ASes never compete at seeding time, so they are put in AS
+    // order; seeds of one AS keep their order, which can break a tie.
+    std::unordered_map<std::string, uint32_t> first;
+    std::vector<const SeedRoute*> seeds;
+    std::vector<uint32_t> path;
+    std::string key;
+    auto put = [&](uint32_t v) { key.append(reinterpret_cast<const char*>(&v), sizeof v); };
+    size_t kept = 0;
+    for (uint32_t p : todo) {
+        const PrefixRIB &rib = _ribs[p];
+        seeds.clear();
+        for (const SeedRoute &seed : rib.seeds()) seeds.push_back(&seed);
+        std::stable_sort(seeds.begin(), seeds.end(),
+                         [](const SeedRoute* a, const SeedRoute* b) { return a->node < b->node; });
+        key.clear();
+        for (const SeedRoute *seed : seeds) {
+            put(seed->node);
+            key.push_back(static_cast<char>(seed->route.rel));
+            put(seed->route.len);
+            put(seed->route.next_hop);
+            rib.paths().materialize(seed->route.path, path);
+            for (uint32_t asn : path) put(asn);
+        }
+        auto found = first.emplace(key, p);
+        if (found.second) {
+            todo[kept++] = p;
+        } else {
+            _route_owner[p] = found.first->second;
+        }
+    }
+    _stats.shared = todo.size() - kept;
+    todo.resize(kept);
+}
+
+void ASGraph::unshare(uint32_t prefix) {
+    if (prefix >= _route_owner.size()) return;
+    if (!_propagated) {
+        // Before propagation every RIB holds just its own seeds
+        _route_owner.clear();
+        return;
+    }
+
+    // A member leaves its group; an owner hands its group to the next member
+    uint32_t detached = PrefixTable::kInvalid;
+    if (_route_owner[prefix] != prefix) {
+        detached = prefix;
+        _route_owner[prefix] = prefix;
+    } else {
+        for (uint32_t q = 0; q < _route_owner.size(); ++q) {
+            if (q == prefix || _route_owner[q] != prefix) continue;
+            if (detached == PrefixTable::kInvalid) detached = q;
+            _route_owner[q] = detached;
         }
     }
-    // Process phase: all ASes process their received_queue
-    for (const auto &p : _node_map) {
-        uint32_t asn = p.first;
-        p.second->policy->processAnnouncementsFor(asn);
-    }
-
-    // DOWNWARD propagation: from maxrank down to 0
-    for (int r = maxrank; r >= 0; --r) {
-        // Send from this rank down to customers
-        for (uint32_t asn : ranks[r]) {
-            auto node_it = _node_map.find(asn);
-            if (node_it == _node_map.end()) continue;
-            auto node = node_it->second;
-            const auto &rib = node->policy->getLocalRIB();
-            for (const auto &kv : rib) {
-                const std::string &prefix = kv.first;
-                const Announcement &stored = kv.second;
-                for (uint32_t cust : node->_customers) {
-                    Announcement sent(prefix, asn, Relationship::Provider, stored.as_path, stored.rov_invalid);
-                    _node_map[cust]->policy->receiveAnnouncement(sent);
+    if (detached == PrefixTable::kInvalid) return;
+
+    PrefixRIB &rib = _ribs[detached];
+    reseed(rib);
+    if (rib.count() == 0) return;
+    refreshImportRules();
+    PropagationScratch scratch;
+    withImportFilter(rib, [&](const auto &accepts) { propagatePrefix(rib, scratch, accepts); });
+}
+
+void ASGraph::refreshImportRules() {
+    _drops_invalid.assign(_nodes.size(), 0);
+    _any_drops_invalid = false;
+    _custom_import = false;
+    for (uint32_t i = 0; i < _nodes.size(); ++i) {
+        switch (_nodes[i].policy->importRule()) {
+            case ImportRule::AcceptAll:
+                break;
+            case ImportRule::DropROVInvalid:
+                _drops_invalid[i] = 1;
+                _any_drops_invalid = true;
+                break;
+            case ImportRule::Custom:
+                _custom_import = true;
+                break;
+        }
+    }
+}
+
+template <typename Body>
+void ASGraph::withImportFilter(const PrefixRIB& rib, Body&& body) const {
+    if (_custom_import) {
+        body([this](uint32_t node, bool rov_invalid) { return policyAccepts(node, rov_invalid); });
+        return;
+    }
+    // Every route of a prefix descends from one of its seeds
+    bool invalid = false;
+    for (const SeedRoute &seed : rib.seeds()) invalid = invalid || (seed.route.rel & RouteEntry::kROVInvalid);
+    if (invalid && _any_drops_invalid) {
+        body(DropInvalidFilter{_drops_invalid.data()});
+    } else {
+        body(AcceptAllFilter{});
+    }
+}
+
+void PropagationStats::merge(const PropagationStats& other) {
+    prefixes += other.prefixes;
+    offers += other.offers;
+    steps += other.steps;
+    peak_pending = std::max(peak_pending, other.peak_pending);
+    arena_heap_blocks += other.arena_heap_blocks;
+    arena_bytes += other.arena_bytes;
+    sent_up += other.sent_up;
+    sent_across += other.sent_across;
+    sent_down += other.sent_down;
+    scanned += other.scanned;
+}
+
+template <typename Filter>
+void ASGraph::propagatePrefix(PrefixRIB& rib, PropagationScratch& scratch, const Filter& accepts) const {
+    const auto &ranks = _ranks;
+    const int maxrank = (int)ranks.size() - 1;
+    const CSRGraph &csr = adjacency();
+    const uint8_t from_customer = BGP::rankOf(Relationship::Customer) | RouteEntry::kPhaseUp;
+    const uint8_t from_peer = BGP::rankOf(Relationship::Peer) | RouteEntry::kPhaseAcross;
+    const uint8_t from_provider = BGP::rankOf(Relationship::Provider) | RouteEntry::kPhaseDown;
+
+    RouteColumns &work = scratch.work;
+    RouteColumns &best = scratch.best;
+    std::vector<uint32_t> &touched = scratch.touched;
+    PropagationStats &stats = scratch.stats;
+    ++stats.prefixes;
+    stats.scanned += _nodes.size();
+    rib.scatter(work, _nodes.size());
+    if (_receive_mode == ReceiveMode::Streaming) best.reset(_nodes.size());
+    PathPool &paths = rib.paths();
+
+    // Only ASes that hold a route have anything to send, so each phase walks
+    // the frontier (those ASes, by rank) instead of every rank. An AS joins
+    // when it first stores a route and never leaves: routes are only replaced.
+    auto &frontier = scratch.frontier;
+    frontier.resize(ranks.size());
+    for (auto &f : frontier) f.clear();
+    rib.forEach([&](uint32_t node, const RouteEntry&) { frontier[_nodes[node]._propagation_rank].push_back(node); });
+
+    // Store `offered` at `to` if it beats the current route; the stored path
+    // is the receiver's ASN followed by the sender's path
+    auto store = [&](uint32_t to, RouteEntry offered) {
+        if (!BGP::better(offered, work.get(to))) return;
+        if (work.rel[to] == 0) frontier[_nodes[to]._propagation_rank].push_back(to);
+        offered.path = paths.push(_nodes[to]._asn, offered.path);
+        work.put(to, offered);
+    };
+
+    // One step: `send_all` offers the routes of the sending ASes to their
+    // neighbors, then each receiver keeps the best offer if it beats its
+    // current route. Taking the best offer first and comparing it with the
+    // stored route selects the same route as comparing offers one by one.
+    //
+    // Processing all receivers of a step at once matches processing them rank
+    // by rank: in the up (down) phase a receiver has a higher (lower) rank than
+    // every sender of the step, so it does not send before all of its
+    // customers (providers) have, and within a step no sender's route changes.
+    auto step = [&](auto&& send_all) {
+        ++stats.steps;
+        if (_receive_mode == ReceiveMode::Streaming) {
+            // Reduce on arrival: one candidate row per receiving AS
+            send_all([&](uint32_t from, CSRGraph::Range targets, uint8_t rel) {
+                const uint8_t flags = work.rel[from] & RouteEntry::kROVInvalid;
+                const RouteEntry offered{uint8_t(rel | flags), work.len[from] + 1, _nodes[from]._asn, work.path[from]};
+                for (uint32_t to : targets) {
+                    if (!accepts(to, flags != 0)) continue;
+                    ++stats.offers;
+                    if (best.rel[to] == 0) {
+                        touched.push_back(to);
+                        best.put(to, offered);
+                    } else if (BGP::better(offered, best.get(to))) {
+                        best.put(to, offered);
+                    }
                 }
+            });
+            stats.peak_pending = std::max<uint64_t>(stats.peak_pending, touched.size());
+
+            for (uint32_t to : touched) {
+                store(to, best.get(to));
+                best.rel[to] = 0;
             }
+            touched.clear();
+            return;
         }
 
-        // Process next lower rank (r-1)
-        if (r - 1 >= 0) {
-            for (uint32_t asn : ranks[r - 1]) {
-                auto node_it = _node_map.find(asn);
-                if (node_it == _node_map.end()) continue;
-                node_it->second->policy->processAnnouncementsFor(asn);
-            }
+        // Queued: keep every offer of the step in the arena, reduce afterwards
+        {
+            std::pmr::vector<RouteOffer> queue(scratch.arena.resource());
+            send_all([&](uint32_t from, CSRGraph::Range targets, uint8_t rel) {
+                const uint8_t flags = work.rel[from] & RouteEntry::kROVInvalid;
+                for (uint32_t to : targets) {
+                    if (!accepts(to, flags != 0)) continue;
+                    queue.push_back({to, _nodes[from]._asn, work.len[from] + 1, work.path[from], uint8_t(rel | flags)});
+                }
+            });
+            stats.offers += queue.size();
+            stats.peak_pending = std::max<uint64_t>(stats.peak_pending, queue.size());
+
+            for (const RouteOffer &o : queue) store(o.to, RouteEntry{o.rel, o.len, o.next_hop, o.path});
         }
+        scratch.arena.reset();
+    };
+
+    // Receivers of a step are appended to the frontier only after all of its
+    // sends, and in the up (down) phase only to higher (lower) ranks, so the
+    // rank being sent from does not change while it is walked.
+
+    // UPWARD propagation: rank r sends to its providers
+    for (int r = 0; r < maxrank; ++r) {
+        if (frontier[r].empty()) continue;
+        stats.sent_up += frontier[r].size();
+        step([&](auto&& send) {
+            for (uint32_t i : frontier[r]) send(i, csr.providers(i), from_customer);
+        });
     }
+
+    // ACROSS (peers): every AS with a route sends one hop to its peers, then all process
+    const size_t holders = std::accumulate(frontier.begin(), frontier.end(), size_t(0),
+                                           [](size_t n, const std::vector<uint32_t>& f) { return n + f.size(); });
+    if (holders != 0) {
+        stats.sent_across += holders;
+        step([&](auto&& send) {
+            for (const auto &f : frontier) {
+                for (uint32_t i : f) send(i, csr.peers(i), from_peer);
+            }
+        });
+    }
+
+    // DOWNWARD propagation: rank r sends to its customers
+    for (int r = maxrank; r > 0; --r) {
+        if (frontier[r].empty()) continue;
+        stats.sent_down += frontier[r].size();
+        step([&](auto&& send) {
+            for (uint32_t i : frontier[r]) send(i, csr.customers(i), from_provider);
+        });
+    }
+
+    rib.gather(work);
 }
 
-void ASGraph::dumpRIBsToCSV(const std::string& filename) const {
-    std::ofstream out(filename);
-    if (!out.is_open()) {
-        std::cerr << "Error: Could not open output file " << filename << std::endl;
-        return;
+void ASGraph::propagateWithROV(uint32_t prefix, const std::vector<uint8_t>& rov, PrefixRIB& out,
+                               PropagationScratch& scratch) const {
+    auto accepts = [&](uint32_t node, bool rov_invalid) { return !rov_invalid || node >= rov.size() || !rov[node]; };
+
+    out = PrefixRIB();
+    if (prefix >= _ribs.size()) return;
+    std::vector<uint32_t> path;
+    for (const SeedRoute &seed : _ribs[prefix].seeds()) {
+        RouteEntry route = seed.route;
+        _ribs[prefix].paths().materialize(seed.route.path, path);
+        route.path = out.paths().append(path);
+        out.addSeed(seed.node, route);
+        // Same rule as seedAnnouncement()
+        if (!accepts(seed.node, (route.rel & RouteEntry::kROVInvalid) != 0)) continue;
+        RouteEntry current;
+        if (out.find(seed.node, current) && !BGP::better(route, current)) continue;
+        out.set(seed.node, route, _nodes.size());
     }
+    if (out.count() != 0 && !_ranks.empty()) propagatePrefix(out, scratch, accepts);
+}
 
-    out << "asn,prefix,as_path\n";
+const std::vector<SeedRoute>& ASGraph::seedsOf(uint32_t prefix) const {
+    static const std::vector<SeedRoute> none;
+    return prefix < _ribs.size() ? _ribs[prefix].seeds() : none;
+}
 
-    std::vector<uint32_t> asns;
-    asns.reserve(_node_map.size());
-    for (const auto &p : _node_map) asns.push_back(p.first);
-    std::sort(asns.begin(), asns.end());
+size_t ASGraph::routeCount() const {
+    size_t routes = 0;
+    for (uint32_t p = 0; p < _ribs.size(); ++p) routes += routesOf(p).count();
+    return routes;
+}
+
+uint32_t ASGraph::routeFor(uint32_t asn, const Prefix& address) const {
+    auto it = _index.find(asn);
+    RouteEntry route;
+    return it == _index.end() ? PrefixTable::kInvalid : routeAt(it->second, address, route);
+}
+
+uint32_t ASGraph::routeAt(uint32_t node, const Prefix& address, RouteEntry& route) const {
+    const uint32_t p = _prefix_index.longestMatch(
+        address, [&](uint32_t q) { return q < _ribs.size() && routesOf(q).find(node, route); });
+    // The lookup fills `route` for each prefix it tries; read the match itself
+    if (p != PrefixTable::kInvalid) routesOf(p).find(node, route);
+    return p;
+}
+
+void ASGraph::routesFor(uint32_t asn, const std::vector<Prefix>& addresses, std::vector<uint32_t>& out) const {
+    out.assign(addresses.size(), PrefixTable::kInvalid);
+    auto it = _index.find(asn);
+    if (it == _index.end()) return;
+    const uint32_t node = it->second;
+    RouteEntry route;
+    _prefix_index.longestMatches(addresses.data(), addresses.size(), out.data(),
+                                 [&](uint32_t p) { return p < _ribs.size() && routesOf(p).find(node, route); });
+}
+
+template <typename Filter>
+void ASGraph::propagatePrefixParallel(PrefixRIB& rib, PropagationScratch& scratch, WorkStealingPool& pool,
+                                      const Filter& accepts) {
+    const auto &ranks = _ranks;
+    const int maxrank = (int)ranks.size() - 1;
+    const CSRGraph &csr = adjacency();
+    const uint8_t from_customer = BGP::rankOf(Relationship::Customer) | RouteEntry::kPhaseUp;
+    const uint8_t from_peer = BGP::rankOf(Relationship::Peer) | RouteEntry::kPhaseAcross;
+    const uint8_t from_provider = BGP::rankOf(Relationship::Provider) | RouteEntry::kPhaseDown;
+    // Chunk size for stealing: big enough to amortize the queue operations,
+    // small enough that rank 0 and the large lower ranks spread over all workers
+    const size_t grain = 256;
+
+    RouteColumns &work = scratch.work;
+    RouteColumns &best = scratch.best;
+    PropagationStats &stats = scratch.stats;
+    ++stats.prefixes;
+    rib.scatter(work, _nodes.size());
+    best.reset(_nodes.size());
+    PathPool &paths = rib.paths();
+
+    struct alignas(64) WorkerCounts {
+        uint64_t offers = 0;
+        std::vector<uint64_t> keys;  // packed keys of the current AS's offers
+    };
+    std::vector<WorkerCounts> counts(pool.size());
+
+    // Delivery is pull-based: each receiving AS reads the routes of the
+    // neighbors that would send to it and keeps the best acceptable one in
+    // its own row of `best`. Workers only write rows of the ASes they were
+    // given and only read `work`, so no two threads touch the same route.
+    // The offers are packed into RouteKeys (kNone where the filter rejects
+    // one) and the winner is the minimum key.
+    auto pull = [&](uint32_t i, CSRGraph::Range sources, uint8_t rel, unsigned worker) {
+        std::vector<uint64_t> &keys = counts[worker].keys;
+        keys.resize(sources.size());
+        uint64_t accepted = 0;
+        for (size_t k = 0; k < sources.size(); ++k) {
+            const uint32_t from = sources[k];
+            const uint8_t flags = work.rel[from] & RouteEntry::kROVInvalid;
+            const bool offered = work.rel[from] != 0 && accepts(i, flags != 0);
+            accepted += offered;
+            keys[k] = offered ? RouteKey::pack(rel, work.len[from] + 1, _nodes[from]._asn) : RouteKey::kNone;
+        }
+        counts[worker].offers += accepted;
+        const size_t k = RouteKey::argMin(keys.data(), keys.size());
+        if (k == keys.size() || keys[k] == RouteKey::kNone) return;
+
+        const uint32_t from = sources[k];
+        const uint8_t flags = work.rel[from] & RouteEntry::kROVInvalid;
+        const RouteEntry candidate{uint8_t(rel | flags), work.len[from] + 1, _nodes[from]._asn, work.path[from]};
+        if (BGP::better(candidate, work.get(i))) best.put(i, candidate);
+    };
+
+    // Commit the winners of a step in index order on this thread, which is
+    // also where their path cells are allocated
+    auto commit = [&](auto&& for_each_node) {
+        uint64_t pending = 0;
+        for_each_node([&](uint32_t i) {
+            if (best.rel[i] == 0) return;
+            RouteEntry chosen = best.get(i);
+            chosen.path = paths.push(_nodes[i]._asn, chosen.path);
+            work.put(i, chosen);
+            best.rel[i] = 0;
+            ++pending;
+        });
+        ++stats.steps;
+        stats.peak_pending = std::max(stats.peak_pending, pending);
+    };
+
+    // One rank: its ASes pull from their `sources` neighbors in parallel
+    auto rankStep = [&](const std::vector<uint32_t> &rank, CSRGraph::Kind sources, uint8_t rel) {
+        pool.parallelFor(rank.size(), grain, [&](size_t b, size_t e, unsigned worker) {
+            for (size_t k = b; k < e; ++k) pull(rank[k], csr.neighbors(sources, rank[k]), rel, worker);
+        });
+        commit([&](auto &&visit) {
+            for (uint32_t i : rank) visit(i);
+        });
+    };
+
+    // UPWARD: rank r takes its customers' routes (all of lower rank, so final)
+    for (int r = 1; r <= maxrank; ++r) rankStep(ranks[r], CSRGraph::Customers, from_customer);
+
+    // ACROSS: every AS takes its peers' routes as they were after the up phase
+    const uint32_t n = static_cast<uint32_t>(work.size());
+    pool.parallelFor(n, grain, [&](size_t b, size_t e, unsigned worker) {
+        for (size_t i = b; i < e; ++i) pull(static_cast<uint32_t>(i), csr.peers(static_cast<uint32_t>(i)), from_peer, worker);
+    });
+    commit([&](auto &&visit) {
+        for (uint32_t i = 0; i < n; ++i) visit(i);
+    });
+
+    // DOWNWARD: rank r takes its providers' routes (all of higher rank, so final)
+    for (int r = maxrank - 1; r >= 0; --r) rankStep(ranks[r], CSRGraph::Providers, from_provider);
 
-    for (uint32_t asn : asns) {
-        auto it = _node_map.find(asn);
-        if (it == _node_map.end()) continue;
-        auto node = it->second;
-        if (!node->policy) continue;
-        const auto &rib = node->policy->getLocalRIB();
-        for (const auto &kv : rib) {
-            const std::string &prefix = kv.first;
-            const Announcement &ann = kv.second;
-
-            // Format AS-path as (a, b, c) with a trailing comma for single-element paths: (a,)
-            std::ostringstream path_ss;
-            path_ss << '(';
-            for (size_t i = 0; i < ann.as_path.size(); ++i) {
-                if (i) path_ss << ", ";
-                path_ss << ann.as_path[i];
+    for (const WorkerCounts &c : counts) stats.offers += c.offers;
+    rib.gather(work);
+}
+
+size_t ASGraph::updatePrefix(PrefixRIB& rib, uint32_t node) {
+    if (!_propagated) {
+        // The RIB only holds seeds so far
+        const RouteEntry seed = seedRoute(rib, node);
+        if (seed.rel != 0) {
+            rib.set(node, seed, _nodes.size());
+        } else {
+            rib.erase(node);
+        }
+        return 1;
+    }
+
+    const auto &ranks = _ranks;
+    const CSRGraph &csr = adjacency();
+    const uint8_t from_customer = BGP::rankOf(Relationship::Customer) | RouteEntry::kPhaseUp;
+    const uint8_t from_peer = BGP::rankOf(Relationship::Peer) | RouteEntry::kPhaseAcross;
+    const uint8_t from_provider = BGP::rankOf(Relationship::Provider) | RouteEntry::kPhaseDown;
+    PathPool &paths = rib.paths();
+
+    // The pull form of propagation: after the up phase an AS holds the best of
+    // its seed and its customers' up routes, after across the best of that and
+    // its peers' up routes, and at the end the best of that and its providers'
+    // final routes. Only ASes with a changed input are re-evaluated, starting
+    // from `node`, whose seeds or import filter changed.
+    //
+    // Routes of ASes that are not re-evaluated come from the RIB. The phase
+    // bits tell what such an AS held after the earlier phases: a later phase
+    // only replaces a route of a lower relationship rank, so the route it had
+    // after the up (across) phase is the stored one if that was stored by then,
+    // and otherwise its seed.
+    struct NodeState {
+        RouteEntry up, across;
+        uint8_t flags = 0;
+    };
+    enum : uint8_t { kHasUp = 1, kHasAcross = 2, kQueuedUp = 4, kQueuedAcross = 8, kQueuedDown = 16 };
+    std::unordered_map<uint32_t, NodeState> state;
+    std::vector<std::vector<uint32_t>> queued(ranks.size());
+    std::vector<uint32_t> across_queue;
+
+    auto stored = [&](uint32_t i) {
+        RouteEntry r;
+        rib.find(i, r);
+        return r;
+    };
+    // Routes before the update (read before the AS's final route is rewritten)
+    auto oldUp = [&](uint32_t i) {
+        const RouteEntry r = stored(i);
+        const uint8_t phase = r.rel & RouteEntry::kPhaseMask;
+        if (r.rel != 0 && (phase == RouteEntry::kPhaseSeed || phase == RouteEntry::kPhaseUp)) return r;
+        return seedRoute(rib, i);
+    };
+    auto oldAcross = [&](uint32_t i) {
+        const RouteEntry r = stored(i);
+        if (r.rel != 0 && (r.rel & RouteEntry::kPhaseMask) != RouteEntry::kPhaseDown) return r;
+        return oldUp(i);
+    };
+    // Routes after the update
+    auto upRoute = [&](uint32_t i) {
+        auto it = state.find(i);
+        if (it != state.end() && (it->second.flags & kHasUp)) return it->second.up;
+        return oldUp(i);
+    };
+    auto acrossRoute = [&](uint32_t i) {
+        auto it = state.find(i);
+        if (it != state.end() && (it->second.flags & kHasAcross)) return it->second.across;
+        return oldAcross(i);
+    };
+
+    // Best of `initial` and the acceptable offers of `sources`. If the winner
+    // is the same offer as `previous`, its path cell is reused so unchanged
+    // routes compare equal.
+    auto select = [&](uint32_t i, RouteEntry initial, CSRGraph::Range sources, auto&& route_of, uint8_t rel,
+                      const RouteEntry& previous) {
+        const Policy &policy = *_nodes[i].policy;
+        RouteEntry chosen = initial;
+        bool offered = false;
+        for (uint32_t from : sources) {
+            const RouteEntry r = route_of(from);
+            if (r.rel == 0) continue;
+            const uint8_t flags = r.rel & RouteEntry::kROVInvalid;
+            if (!policy.acceptsAnnouncement(flags != 0)) continue;
+            const RouteEntry candidate{uint8_t(rel | flags), r.len + 1, _nodes[from]._asn, r.path};
+            if (BGP::better(candidate, chosen)) {
+                chosen = candidate;
+                offered = true;
             }
-            if (ann.as_path.size() == 1) path_ss << ','; // ensure single-element has trailing comma
-            path_ss << ')';
+        }
+        if (!offered) return chosen;
+        if (previous.rel == chosen.rel && previous.len == chosen.len && previous.next_hop == chosen.next_hop &&
+            previous.path != PathPool::kEnd && paths.rest(previous.path) == chosen.path) {
+            chosen.path = previous.path;
+        } else {
+            chosen.path = paths.push(_nodes[i]._asn, chosen.path);
+        }
+        return chosen;
+    };
+
+    auto queueUp = [&](uint32_t i) {
+        NodeState &st = state[i];
+        if (st.flags & kQueuedUp) return;
+        st.flags |= kQueuedUp;
+        queued[_nodes[i]._propagation_rank].push_back(i);
+    };
+    auto queueAcross = [&](uint32_t i) {
+        NodeState &st = state[i];
+        if (st.flags & kQueuedAcross) return;
+        st.flags |= kQueuedAcross;
+        across_queue.push_back(i);
+    };
+    auto queueDown = [&](uint32_t i) {
+        NodeState &st = state[i];
+        if (st.flags & kQueuedDown) return;
+        st.flags |= kQueuedDown;
+        queued[_nodes[i]._propagation_rank].push_back(i);
+    };
 
-            out << asn << ',' << prefix << ',' << '"' << path_ss.str() << '"' << '\n';
+    // `node` itself is always treated as changed: its earlier routes cannot be
+    // recovered once its seeds or filter are different. The others are only
+    // queued on neighbors of a lower (up) or higher (down) rank, so each rank
+    // is complete by the time it is reached.
+    queueUp(node);
+    for (size_t r = 0; r < ranks.size(); ++r) {
+        for (uint32_t i : queued[r]) {
+            const RouteEntry before = oldUp(i);
+            const RouteEntry after = select(i, seedRoute(rib, i), csr.customers(i), upRoute, from_customer, before);
+            NodeState &st = state[i];
+            st.up = after;
+            st.flags |= kHasUp;
+            if (after == before && i != node) continue;
+            queueAcross(i);
+            for (uint32_t p : csr.providers(i)) queueUp(p);
+            for (uint32_t q : csr.peers(i)) queueAcross(q);
         }
+        queued[r].clear();
     }
 
-    out.close();
-}
\ No newline at end of file
+    queueAcross(node);
+    for (uint32_t i : across_queue) {
+        const RouteEntry before = oldAcross(i);
+        const RouteEntry after = select(i, upRoute(i), csr.peers(i), upRoute, from_peer, before);
+        NodeState &st = state[i];
+        st.across = after;
+        st.flags |= kHasAcross;
+        if (after == before && i != node) continue;
+        queueDown(i);
+    }
+
+    queueDown(node);
+    for (size_t r = ranks.size(); r-- > 0;) {
+        for (uint32_t i : queued[r]) {
+            const RouteEntry before = stored(i);
+            const RouteEntry after = select(i, acrossRoute(i), csr.providers(i), stored, from_provider, before);
+            if (after == before && i != node) continue;
+            if (after.rel != 0) {
+                rib.set(i, after, _nodes.size());
+            } else {
+                rib.erase(i);
+            }
+            for (uint32_t c : csr.customers(i)) queueDown(c);
+        }
+    }
+    return state.size();
+}
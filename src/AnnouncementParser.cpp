@@ -0,0 +1,68 @@
+#include "AnnouncementParser.h"
+
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Next ','-separated field starting at `p`, trimmed. Advances `p` past the comma.
+bool nextField(const char*& p, const char* end, std::string_view& field, bool last) {
+    if (p > end) return false;
+    const char* sep = static_cast<const char*>(std::memchr(p, ',', end - p));
+    if (!sep && !last) return false;
+    const char* b = p;
+    const char* e = sep ? sep : end;
+    while (b < e && isBlank(*b)) ++b;
+    while (e > b && isBlank(e[-1])) --e;
+    field = std::string_view(b, static_cast<size_t>(e - b));
+    p = sep ? sep + 1 : end + 1;
+    return true;
+}
+
+} // namespace
+
+bool parseAnnouncementLine(const char* begin, const char* end, AnnouncementRow& out) {
+    const char* p = begin;
+    std::string_view asn_s, prefix, rov_s;
+    if (!nextField(p, end, asn_s, false)) return false;
+    if (!nextField(p, end, prefix, false)) return false;
+    if (!nextField(p, end, rov_s, true)) return false;
+    if (asn_s.empty() || prefix.empty()) return false;
+
+    auto res = std::from_chars(asn_s.data(), asn_s.data() + asn_s.size(), out.seed_asn);
+    if (res.ec != std::errc() || res.ptr != asn_s.data() + asn_s.size()) return false;
+
+    if (!parsePrefix(prefix, out.parsed_prefix)) return false;
+    out.prefix = prefix;
+    out.rov_invalid = (rov_s == "True");
+    return true;
+}
+
+void parseAnnouncements(const char* begin, const char* end,
+                        std::vector<AnnouncementRow>& rows,
+                        ParseReport& report,
+                        size_t first_line) {
+    size_t line_no = first_line;
+    const char* p = begin;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* line_end = nl ? nl : end;
+
+        const char* q = p;
+        while (q < line_end && isBlank(*q)) ++q;
+        if (q < line_end && *q != '#') {
+            AnnouncementRow row;
+            if (parseAnnouncementLine(p, line_end, row)) {
+                rows.push_back(row);
+            } else {
+                report.malformed_lines.push_back(line_no);
+            }
+        }
+
+        ++report.lines;
+        ++line_no;
+        p = nl ? nl + 1 : end;
+    }
+}
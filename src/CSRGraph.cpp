@@ -0,0 +1,49 @@
+#include "CSRGraph.h"
+
+#include <algorithm>
+
+namespace {
+
+// Sort (source, target) pairs, drop duplicates and lay them out as CSR rows.
+void buildRows(uint32_t num_nodes, std::vector<std::pair<uint32_t, uint32_t>>& edges,
+               std::vector<uint32_t>& offsets, std::vector<uint32_t>& targets) {
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    offsets.assign(num_nodes + 1, 0);
+    for (const auto& e : edges) ++offsets[e.first + 1];
+    for (uint32_t i = 0; i < num_nodes; ++i) offsets[i + 1] += offsets[i];
+
+    targets.resize(edges.size());
+    for (size_t k = 0; k < edges.size(); ++k) targets[k] = edges[k].second;
+}
+
+} // namespace
+
+void CSRGraph::build(uint32_t num_nodes,
+                     std::vector<std::pair<uint32_t, uint32_t>> provider_edges,
+                     std::vector<std::pair<uint32_t, uint32_t>> peer_edges) {
+    _num_nodes = num_nodes;
+
+    // customers: rows keyed by provider
+    buildRows(num_nodes, provider_edges, _offsets[Customers], _targets[Customers]);
+
+    // providers: same edges, rows keyed by customer
+    for (auto& e : provider_edges) std::swap(e.first, e.second);
+    buildRows(num_nodes, provider_edges, _offsets[Providers], _targets[Providers]);
+
+    // peers: symmetric, store both directions
+    const size_t n = peer_edges.size();
+    peer_edges.reserve(n * 2);
+    for (size_t k = 0; k < n; ++k) {
+        const auto e = peer_edges[k];
+        peer_edges.emplace_back(e.second, e.first);
+    }
+    buildRows(num_nodes, peer_edges, _offsets[Peers], _targets[Peers]);
+}
+
+void CSRGraph::assign(uint32_t num_nodes, Kind kind, std::vector<uint32_t> offsets, std::vector<uint32_t> targets) {
+    _num_nodes = num_nodes;
+    _offsets[kind] = std::move(offsets);
+    _targets[kind] = std::move(targets);
+}
@@ -0,0 +1,23 @@
+#include "ChunkedParse.h"
+
+#include <cstring>
+
+std::vector<std::pair<const char*, const char*>> splitAtLines(const char* begin, const char* end, size_t parts) {
+    std::vector<std::pair<const char*, const char*>> chunks;
+    if (begin >= end) return chunks;
+    if (parts == 0) parts = 1;
+
+    const size_t target = static_cast<size_t>(end - begin) / parts;
+    const char* p = begin;
+    while (p < end) {
+        const char* cut = end;
+        if (chunks.size() + 1 < parts && static_cast<size_t>(end - p) > target) {
+            // Move the cut forward to just past the next newline
+            const char* nl = static_cast<const char*>(std::memchr(p + target, '\n', end - (p + target)));
+            cut = nl ? nl + 1 : end;
+        }
+        chunks.emplace_back(p, cut);
+        p = cut;
+    }
+    return chunks;
+}
@@ -0,0 +1,245 @@
+#include "Decompressor.h"
+
+#include <bzlib.h>
+#include <zlib.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool endsWith(const std::string& s, const char* suffix) {
+    const size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+// Pull-style decoder: read() fills `buf` and returns the byte count, 0 at end
+// of stream and -1 on error (with `error` set).
+class Source {
+public:
+    virtual ~Source() = default;
+    virtual long read(char* buf, size_t cap) = 0;
+    std::string error;
+};
+
+class GzipSource : public Source {
+    gzFile _f;
+public:
+    explicit GzipSource(gzFile f) : _f(f) { gzbuffer(_f, 1 << 18); }
+    ~GzipSource() override { gzclose(_f); }
+
+    long read(char* buf, size_t cap) override {
+        int n = gzread(_f, buf, static_cast<unsigned>(cap));
+        if (n <= 0) {
+            // A truncated file reads as a clean end of stream, so check the
+            // error state there too
+            int errnum = Z_OK;
+            const char* msg = gzerror(_f, &errnum);
+            if (n < 0 || errnum != Z_OK) {
+                error = msg;
+                return -1;
+            }
+        }
+        return n;
+    }
+};
+
+class Bzip2Source : public Source {
+    FILE* _f;
+    BZFILE* _bz = nullptr;
+    bool _eof = false;
+
+    bool openStream(void* unused, int n_unused) {
+        int bzerr = BZ_OK;
+        _bz = BZ2_bzReadOpen(&bzerr, _f, 0, 0, unused, n_unused);
+        if (bzerr != BZ_OK) {
+            error = "could not start bzip2 stream";
+            _bz = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+public:
+    explicit Bzip2Source(FILE* f) : _f(f) {}
+    ~Bzip2Source() override {
+        int bzerr;
+        if (_bz) BZ2_bzReadClose(&bzerr, _bz);
+        std::fclose(_f);
+    }
+
+    bool start() { return openStream(nullptr, 0); }
+
+    long read(char* buf, size_t cap) override {
+        while (!_eof) {
+            int bzerr = BZ_OK;
+            int n = BZ2_bzRead(&bzerr, _bz, buf, static_cast<int>(cap));
+            if (bzerr == BZ_OK) return n;
+            if (bzerr != BZ_STREAM_END) {
+                error = "corrupt bzip2 data";
+                return -1;
+            }
+
+            // End of one stream: parallel compressors (pbzip2, lbzip2) write
+            // several concatenated streams, so continue with any leftover input.
+            void* unused_ptr = nullptr;
+            int n_unused = 0;
+            BZ2_bzReadGetUnused(&bzerr, _bz, &unused_ptr, &n_unused);
+            std::vector<char> unused(static_cast<char*>(unused_ptr), static_cast<char*>(unused_ptr) + n_unused);
+            BZ2_bzReadClose(&bzerr, _bz);
+            _bz = nullptr;
+
+            if (unused.empty()) {
+                int c = std::fgetc(_f);
+                if (c == EOF) _eof = true;
+                else std::ungetc(c, _f);
+            }
+            if (!_eof && !openStream(unused.data(), static_cast<int>(unused.size()))) return -1;
+            if (n > 0) return n;
+        }
+        return 0;
+    }
+};
+
+std::unique_ptr<Source> openSource(const std::string& filename) {
+    if (endsWith(filename, ".gz")) {
+        gzFile f = gzopen(filename.c_str(), "rb");
+        if (!f) return nullptr;
+        return std::make_unique<GzipSource>(f);
+    }
+    FILE* f = std::fopen(filename.c_str(), "rb");
+    if (!f) return nullptr;
+    auto src = std::make_unique<Bzip2Source>(f);
+    if (!src->start()) return nullptr;
+    return src;
+}
+
+// Bounded single-producer / single-consumer queue of decompressed blocks
+class BlockQueue {
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::deque<std::vector<char>> _blocks;
+    size_t _capacity;
+    bool _closed = false;
+    bool _cancelled = false;
+
+public:
+    explicit BlockQueue(size_t capacity) : _capacity(capacity) {}
+
+    // Returns false if the consumer gave up
+    bool push(std::vector<char> block) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return _blocks.size() < _capacity || _cancelled; });
+        if (_cancelled) return false;
+        _blocks.push_back(std::move(block));
+        _cv.notify_all();
+        return true;
+    }
+
+    // Returns false once the producer has closed the queue and it is drained
+    bool pop(std::vector<char>& block) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return !_blocks.empty() || _closed; });
+        if (_blocks.empty()) return false;
+        block = std::move(_blocks.front());
+        _blocks.pop_front();
+        _cv.notify_all();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closed = true;
+        _cv.notify_all();
+    }
+
+    void cancel() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cancelled = true;
+        _cv.notify_all();
+    }
+};
+
+} // namespace
+
+bool isCompressedPath(const std::string& filename) {
+    return endsWith(filename, ".gz") || endsWith(filename, ".bz2");
+}
+
+bool readCompressedLines(const std::string& filename,
+                         const std::function<void(const char* begin, const char* end)>& consume,
+                         size_t block_size) {
+    std::unique_ptr<Source> source = openSource(filename);
+    if (!source) {
+        std::cerr << "Error: Could not open compressed file " << filename << std::endl;
+        return false;
+    }
+
+    BlockQueue queue(4);
+    bool failed = false;
+    std::thread producer([&]() {
+        for (;;) {
+            std::vector<char> block(block_size);
+            long n = source->read(block.data(), block.size());
+            if (n <= 0) {
+                failed = (n < 0);
+                break;
+            }
+            block.resize(static_cast<size_t>(n));
+            if (!queue.push(std::move(block))) break;
+        }
+        queue.close();
+    });
+
+    // Hand over whole lines only; a line split across blocks is stitched
+    // together in `carry`.
+    std::string carry;
+    std::vector<char> block;
+    try {
+        while (queue.pop(block)) {
+            const char* b = block.data();
+            const char* e = b + block.size();
+            const char* last_nl = nullptr;
+            for (const char* q = e; q > b; --q) {
+                if (q[-1] == '\n') {
+                    last_nl = q - 1;
+                    break;
+                }
+            }
+            if (!last_nl) {
+                carry.append(b, e);
+                continue;
+            }
+
+            const char* first_nl = static_cast<const char*>(std::memchr(b, '\n', e - b));
+            if (!carry.empty()) {
+                carry.append(b, first_nl + 1);
+                consume(carry.data(), carry.data() + carry.size());
+                carry.clear();
+                b = first_nl + 1;
+            }
+            const char* cut = last_nl + 1;
+            if (b < cut) consume(b, cut);
+            carry.assign(cut, e);
+        }
+        if (!carry.empty()) consume(carry.data(), carry.data() + carry.size());
+    } catch (...) {
+        queue.cancel();
+        producer.join();
+        throw;
+    }
+    producer.join();
+
+    if (failed) {
+        std::cerr << "Error: Failed to decompress " << filename << ": " << source->error << std::endl;
+        return false;
+    }
+    return true;
+}
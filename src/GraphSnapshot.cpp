@@ -0,0 +1,196 @@
+#include "GraphSnapshot.h"
+#include "ASGraph.h"
+#include "BGP.h"
+#include "MappedFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+constexpr size_t kAlign = 8;
+
+size_t padded(size_t bytes) { return (bytes + kAlign - 1) & ~(kAlign - 1); }
+
+template <typename T>
+void writeArray(std::ofstream& out, const T* data, size_t count) {
+    const size_t bytes = count * sizeof(T);
+    if (bytes) out.write(reinterpret_cast<const char*>(data), bytes);
+    static const char zeros[kAlign] = {};
+    out.write(zeros, padded(bytes) - bytes);
+}
+
+// Sequential reader over the mapped snapshot with bounds checking
+class Cursor {
+    const char* _p;
+    const char* _end;
+public:
+    Cursor(const char* p, const char* end) : _p(p), _end(end) {}
+
+    template <typename T>
+    bool read(std::vector<T>& out, size_t count) {
+        const size_t bytes = count * sizeof(T);
+        if (static_cast<size_t>(_end - _p) < padded(bytes)) return false;
+        out.resize(count);
+        if (bytes) std::memcpy(out.data(), _p, bytes);
+        _p += padded(bytes);
+        return true;
+    }
+};
+
+} // namespace
+
+bool isGraphSnapshot(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    char magic[sizeof(kSnapshotMagic)] = {};
+    if (!in.read(magic, sizeof(magic))) return false;
+    return std::memcmp(magic, kSnapshotMagic, sizeof(magic)) == 0;
+}
+
+bool ASGraph::writeSnapshot(const std::string& filename) {
+    // Ranks are part of the snapshot; this also rejects cyclic graphs
+    const auto &ranks = rankIndices();
+    const CSRGraph &csr = adjacency();
+
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open snapshot file " << filename << std::endl;
+        return false;
+    }
+
+    const uint32_t n = static_cast<uint32_t>(_nodes.size());
+    SnapshotHeader header{};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.num_nodes = n;
+    header.num_ranks = static_cast<uint32_t>(ranks.size());
+
+    // Nodes added after the last CSR build have no edges; pad their rows
+    std::vector<uint32_t> offsets[3];
+    for (int k = 0; k < 3; ++k) {
+        auto kind = static_cast<CSRGraph::Kind>(k);
+        offsets[k] = csr.offsets(kind);
+        if (offsets[k].empty()) offsets[k].push_back(0);
+        offsets[k].resize(n + 1, offsets[k].back());
+        header.num_edges[k] = csr.targets(kind).size();
+    }
+
+    std::vector<uint32_t> asns(n);
+    for (uint32_t i = 0; i < n; ++i) asns[i] = _nodes[i]._asn;
+
+    std::vector<uint32_t> rank_offsets(1, 0);
+    std::vector<uint32_t> rank_nodes;
+    rank_nodes.reserve(n);
+    for (const auto &rank : ranks) {
+        rank_nodes.insert(rank_nodes.end(), rank.begin(), rank.end());
+        rank_offsets.push_back(static_cast<uint32_t>(rank_nodes.size()));
+    }
+
+    writeArray(out, &header, 1);
+    writeArray(out, asns.data(), asns.size());
+    writeArray(out, rank_offsets.data(), rank_offsets.size());
+    writeArray(out, rank_nodes.data(), rank_nodes.size());
+    for (int k = 0; k < 3; ++k) {
+        const auto &targets = csr.targets(static_cast<CSRGraph::Kind>(k));
+        writeArray(out, offsets[k].data(), offsets[k].size());
+        writeArray(out, targets.data(), targets.size());
+    }
+
+    if (!out) {
+        std::cerr << "Error: Failed writing snapshot file " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ASGraph::loadSnapshot(const std::string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Error: Could not open snapshot file " << filename << std::endl;
+        return false;
+    }
+
+    SnapshotHeader header;
+    if (file.size() < sizeof(header)) {
+        std::cerr << "Error: Snapshot file " << filename << " is truncated" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0) {
+        std::cerr << "Error: " << filename << " is not a graph snapshot" << std::endl;
+        return false;
+    }
+    if (header.version != kSnapshotVersion) {
+        std::cerr << "Error: Snapshot " << filename << " has version " << header.version
+                  << ", expected " << kSnapshotVersion << std::endl;
+        return false;
+    }
+
+    const uint32_t n = header.num_nodes;
+    Cursor cur(file.data() + padded(sizeof(header)), file.end());
+    std::vector<uint32_t> asns, rank_offsets, rank_nodes;
+    std::vector<uint32_t> offsets[3], targets[3];
+
+    bool ok = cur.read(asns, n) &&
+              cur.read(rank_offsets, header.num_ranks + 1) && cur.read(rank_nodes, n);
+    for (int k = 0; ok && k < 3; ++k) {
+        ok = cur.read(offsets[k], n + 1) && cur.read(targets[k], header.num_edges[k]) &&
+             offsets[k].back() == header.num_edges[k];
+    }
+    ok = ok && rank_offsets.front() == 0 && rank_offsets.back() == n;
+    // Indices must stay in range, otherwise propagation would read out of bounds
+    for (int k = 0; ok && k < 3; ++k) {
+        for (uint32_t i = 0; ok && i < n; ++i) ok = offsets[k][i] <= offsets[k][i + 1];
+        for (uint32_t t : targets[k]) ok = ok && t < n;
+    }
+    for (uint32_t r = 0; ok && r < header.num_ranks; ++r) ok = rank_offsets[r] <= rank_offsets[r + 1];
+    // Ranks are derived from the buckets, so every node must sit in exactly one
+    std::vector<int32_t> node_ranks(ok ? n : 0, -1);
+    for (uint32_t r = 0; ok && r < header.num_ranks; ++r) {
+        for (uint32_t j = rank_offsets[r]; ok && j < rank_offsets[r + 1]; ++j) {
+            const uint32_t i = rank_nodes[j];
+            ok = i < n && node_ranks[i] < 0;
+            if (ok) node_ranks[i] = static_cast<int32_t>(r);
+        }
+    }
+    std::unordered_map<uint32_t, uint32_t> index;
+    if (ok) {
+        index.reserve(n);
+        for (uint32_t i = 0; ok && i < n; ++i) ok = index.emplace(asns[i], i).second;
+    }
+    if (!ok) {
+        std::cerr << "Error: Snapshot file " << filename << " is truncated or corrupt" << std::endl;
+        return false;
+    }
+
+    // Replace the current topology
+    _nodes.clear();
+    _index = std::move(index);
+    _ribs.clear();
+    _route_owner.clear();
+    _propagated = false;
+    _provider_edges.clear();
+    _peer_edges.clear();
+    _nodes.reserve(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        _nodes.emplace_back(asns[i], i);
+        _nodes.back().policy = std::make_unique<BGP>();
+        _nodes.back()._propagation_rank = node_ranks[i];
+    }
+
+    for (int k = 0; k < 3; ++k) {
+        _csr.assign(n, static_cast<CSRGraph::Kind>(k), std::move(offsets[k]), std::move(targets[k]));
+    }
+    _csr_dirty = false;
+    _edges_from_csr = true;
+
+    _ranks.assign(header.num_ranks, {});
+    for (uint32_t r = 0; r < header.num_ranks; ++r) {
+        _ranks[r].assign(rank_nodes.begin() + rank_offsets[r], rank_nodes.begin() + rank_offsets[r + 1]);
+    }
+    _provider_cycle.clear();
+    _ranks_valid = true;
+    return true;
+}
@@ -0,0 +1,121 @@
+#include "HijackTrials.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <stdexcept>
+
+#include "ThreadPool.h"
+
+// splitmix64: small, fast and the same on every platform, unlike the
+// std:: distributions
+static uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+HijackTrialRunner::HijackTrialRunner(ASGraph& g) : _graph(g) {
+    if (g.hasProviderCycle()) throw std::runtime_error("Cannot run trials on a graph with a provider cycle");
+
+    std::vector<uint8_t> attacker(g.size(), 0);
+    for (uint32_t p = 0; p < g.prefixes().size(); ++p) {
+        bool hijacked = false;
+        for (const SeedRoute &seed : g.seedsOf(p)) {
+            if (!(seed.route.rel & RouteEntry::kROVInvalid)) continue;
+            hijacked = true;
+            attacker[seed.node] = 1;
+        }
+        if (hijacked) _hijacked.push_back(p);
+    }
+    for (uint32_t i = 0; i < g.size(); ++i) {
+        if (!attacker[i]) _candidates.push_back(i);
+    }
+}
+
+std::vector<uint8_t> HijackTrialRunner::adopters(unsigned percent, unsigned trial, uint64_t seed) const {
+    uint64_t state = mix(mix(seed ^ (uint64_t(percent) << 32)) ^ trial);
+    const size_t n = _candidates.size();
+    const size_t k = std::min(n, static_cast<size_t>(std::llround(double(n) * percent / 100.0)));
+
+    // First k steps of a Fisher-Yates shuffle
+    std::vector<uint32_t> pool = _candidates;
+    std::vector<uint8_t> rov(_graph.size(), 0);
+    for (size_t i = 0; i < k; ++i) {
+        state = mix(state);
+        size_t j = i + static_cast<size_t>(state % (n - i));
+        std::swap(pool[i], pool[j]);
+        rov[pool[i]] = 1;
+    }
+    return rov;
+}
+
+double HijackTrialRunner::hijackSuccess(const std::vector<uint8_t>& rov, PrefixRIB& rib,
+                                        PropagationScratch& scratch) const {
+    uint64_t hijacked = 0, eligible = 0;
+    std::vector<uint32_t> seeders;
+    for (uint32_t p : _hijacked) {
+        seeders.clear();
+        for (const SeedRoute &seed : _graph.seedsOf(p)) seeders.push_back(seed.node);
+        std::sort(seeders.begin(), seeders.end());
+        seeders.erase(std::unique(seeders.begin(), seeders.end()), seeders.end());
+
+        _graph.propagateWithROV(p, rov, rib, scratch);
+        eligible += _graph.size() - seeders.size();
+        rib.forEach([&](uint32_t node, const RouteEntry& route) {
+            if (!(route.rel & RouteEntry::kROVInvalid)) return;
+            if (!std::binary_search(seeders.begin(), seeders.end(), node)) ++hijacked;
+        });
+    }
+    return eligible ? double(hijacked) / double(eligible) : 0.0;
+}
+
+std::vector<HijackTrialSummary> HijackTrialRunner::run(const HijackTrialConfig& config) const {
+    const size_t levels = config.adoption_percents.size();
+    const size_t total = levels * config.trials;
+    std::vector<double> success(total);
+
+    // Trials are handed out one at a time; each worker reuses its own buffers
+    ThreadPool pool(config.threads);
+    std::atomic<size_t> next{0};
+    std::vector<std::future<void>> done;
+    for (unsigned w = 0; w < pool.size(); ++w) {
+        done.push_back(pool.submit([&]() {
+            PrefixRIB rib;
+            PropagationScratch scratch;
+            for (size_t t; (t = next.fetch_add(1)) < total;) {
+                const unsigned percent = config.adoption_percents[t / config.trials];
+                const unsigned trial = static_cast<unsigned>(t % config.trials);
+                success[t] = hijackSuccess(adopters(percent, trial, config.seed), rib, scratch);
+            }
+        }));
+    }
+    for (auto &f : done) f.get();
+
+    std::vector<HijackTrialSummary> summary(levels);
+    for (size_t l = 0; l < levels; ++l) {
+        HijackTrialSummary &s = summary[l];
+        s.adoption_percent = config.adoption_percents[l];
+        s.trials = config.trials;
+        s.adopters = static_cast<unsigned>(
+            std::min(_candidates.size(), static_cast<size_t>(std::llround(double(_candidates.size()) * s.adoption_percent / 100.0))));
+        if (config.trials == 0) continue;
+
+        const double* x = success.data() + l * config.trials;
+        s.min = *std::min_element(x, x + config.trials);
+        s.max = *std::max_element(x, x + config.trials);
+        // Welford's update: identical trials leave m2 at exactly 0, so their
+        // stddev prints as 0 rather than cancellation noise
+        double mean = 0, m2 = 0;
+        for (unsigned t = 0; t < config.trials; ++t) {
+            const double delta = x[t] - mean;
+            mean += delta / (t + 1);
+            m2 += delta * (x[t] - mean);
+        }
+        s.mean = mean;
+        s.stddev = config.trials > 1 ? std::sqrt(m2 / (config.trials - 1)) : 0.0;
+    }
+    return summary;
+}
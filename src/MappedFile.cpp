@@ -0,0 +1,61 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <fstream>
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+#ifdef _WIN32
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open()) return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    _buffer = ss.str();
+    _data = _buffer.data();
+    _size = _buffer.size();
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    _size = static_cast<size_t>(st.st_size);
+    if (_size > 0) {
+        void* p = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            _size = 0;
+            return false;
+        }
+        // Parsers scan front to back, let the kernel read ahead aggressively
+        madvise(p, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const char*>(p);
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+#endif
+    _open = true;
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    _buffer.clear();
+#else
+    if (_data && _size > 0) munmap(const_cast<char*>(_data), _size);
+#endif
+    _data = nullptr;
+    _size = 0;
+    _open = false;
+}
@@ -0,0 +1,29 @@
+#include "PhaseArena.h"
+
+void* CountingResource::do_allocate(size_t bytes, size_t alignment) {
+    ++_allocations;
+    _bytes += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void CountingResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+PhaseArena::PhaseArena() : _buffer(kInitialBytes) {
+    _arena.emplace(_buffer.data(), _buffer.size(), &_upstream);
+}
+
+void PhaseArena::reset() {
+    ++_resets;
+    // Destroying the resource returns its heap blocks upstream
+    _arena.reset();
+
+    const uint64_t spilled = _upstream.bytes() - _spilled_bytes;
+    _spilled_bytes = _upstream.bytes();
+    if (spilled > 0) {
+        // Make the buffer big enough for what this step needed in total
+        std::vector<std::byte>(_buffer.size() + spilled).swap(_buffer);
+    }
+    _arena.emplace(_buffer.data(), _buffer.size(), &_upstream);
+}
@@ -0,0 +1,114 @@
+#include "PrefixIndex.h"
+
+#include <algorithm>
+#include <tuple>
+
+PrefixIndex::Bits PrefixIndex::bitsOf(const Prefix& p) {
+    Bits b;
+    for (int i = 0; i < 8; ++i) b.hi = (b.hi << 8) | p.addr[i];
+    for (int i = 8; i < 16; ++i) b.lo = (b.lo << 8) | p.addr[i];
+    if (!p.ipv6) b.hi &= 0xffffffff00000000ull;
+    return b;
+}
+
+PrefixIndex::Bits PrefixIndex::masked(Bits b, unsigned len) {
+    if (len == 0) return Bits();
+    if (len < 64) {
+        b.hi &= ~0ull << (64 - len);
+        b.lo = 0;
+    } else if (len == 64) {
+        b.lo = 0;
+    } else if (len < 128) {
+        b.lo &= ~0ull << (128 - len);
+    }
+    return b;
+}
+
+uint32_t PrefixIndex::addNode(const Bits& key, unsigned len) {
+    Node node;
+    node.key = key;
+    node.len = static_cast<uint8_t>(len);
+    _nodes.push_back(node);
+    return static_cast<uint32_t>(_nodes.size() - 1);
+}
+
+void PrefixIndex::insert(uint32_t root, const Bits& key, unsigned len, uint32_t ids_begin, uint32_t ids_end) {
+    // Invariant: `key` extends the key of `cur`
+    uint32_t cur = root;
+    for (;;) {
+        if (_nodes[cur].len == len) {
+            _nodes[cur].ids_begin = ids_begin;
+            _nodes[cur].ids_end = ids_end;
+            return;
+        }
+        const unsigned side = bitAt(key, _nodes[cur].len);
+        const uint32_t next = _nodes[cur].child[side];
+        if (next == kNone) {
+            const uint32_t leaf = addNode(key, len);
+            _nodes[leaf].ids_begin = ids_begin;
+            _nodes[leaf].ids_end = ids_end;
+            _nodes[cur].child[side] = leaf;
+            return;
+        }
+
+        const unsigned common = std::min({commonLength(key, _nodes[next].key), len, unsigned(_nodes[next].len)});
+        if (common == _nodes[next].len) {
+            cur = next;
+            continue;
+        }
+
+        // Split the edge to `next` where the keys diverge
+        const uint32_t mid = addNode(masked(key, common), common);
+        _nodes[mid].child[bitAt(_nodes[next].key, common)] = next;
+        _nodes[cur].child[side] = mid;
+        cur = mid;
+    }
+}
+
+void PrefixIndex::build(const PrefixTable& table) {
+    _nodes.clear();
+    _ids.clear();
+    _root4 = addNode(Bits(), 0);
+    _root6 = addNode(Bits(), 0);
+
+    // Group IDs by network so each node gets one contiguous run of IDs
+    struct Entry {
+        bool ipv6;
+        unsigned len;
+        Bits key;
+        uint32_t id;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(table.size());
+    for (uint32_t id = 0; id < table.size(); ++id) {
+        const Prefix &p = table.prefix(id);
+        entries.push_back({p.ipv6, p.length, masked(bitsOf(p), p.length), id});
+    }
+    auto rank = [](const Entry& e) { return std::make_tuple(e.ipv6, e.len, e.key.hi, e.key.lo, e.id); };
+    std::sort(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) { return rank(a) < rank(b); });
+
+    _ids.reserve(entries.size());
+    for (size_t b = 0; b < entries.size();) {
+        size_t e = b;
+        while (e < entries.size() && entries[e].ipv6 == entries[b].ipv6 && entries[e].len == entries[b].len &&
+               entries[e].key.hi == entries[b].key.hi && entries[e].key.lo == entries[b].key.lo) {
+            _ids.push_back(entries[e].id);
+            ++e;
+        }
+        insert(entries[b].ipv6 ? _root6 : _root4, entries[b].key, entries[b].len,
+               static_cast<uint32_t>(_ids.size() - (e - b)), static_cast<uint32_t>(_ids.size()));
+        b = e;
+    }
+}
+
+void PrefixIndex::matches(const Prefix& address, std::vector<uint32_t>& out) const {
+    out.clear();
+    const Bits a = bitsOf(address);
+    for (uint32_t n = address.ipv6 ? _root6 : _root4; n != kNone;) {
+        const Node &node = _nodes[n];
+        if (commonLength(a, node.key) < node.len) break;
+        out.insert(out.begin(), _ids.begin() + node.ids_begin, _ids.begin() + node.ids_end);
+        if (node.len >= address.length) break;
+        n = node.child[bitAt(a, node.len)];
+    }
+}
@@ -0,0 +1,179 @@
+#include "PrefixTable.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+bool parseLength(std::string_view s, unsigned max_len, uint8_t& out) {
+    if (s.empty() || s.size() > 3) return false;
+    unsigned v = 0;
+    auto res = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (res.ec != std::errc() || res.ptr != s.data() + s.size() || v > max_len) return false;
+    out = static_cast<uint8_t>(v);
+    return true;
+}
+
+// Dotted quad into out[0..3]
+bool parseIPv4(std::string_view s, uint8_t* out) {
+    for (int i = 0; i < 4; ++i) {
+        size_t dot = (i < 3) ? s.find('.') : s.size();
+        if (dot == std::string_view::npos || dot == 0 || dot > 3) return false;
+        unsigned v = 0;
+        auto res = std::from_chars(s.data(), s.data() + dot, v);
+        if (res.ec != std::errc() || res.ptr != s.data() + dot || v > 255) return false;
+        out[i] = static_cast<uint8_t>(v);
+        s.remove_prefix(i < 3 ? dot + 1 : dot);
+    }
+    return s.empty();
+}
+
+// RFC 4291 text form, including "::" compression and a trailing dotted quad
+bool parseIPv6(std::string_view s, uint8_t* out) {
+    uint8_t head[16], tail[16];
+    size_t nhead = 0, ntail = 0;
+    bool compressed = false;
+
+    if (s.substr(0, 2) == "::") {
+        compressed = true;
+        s.remove_prefix(2);
+    } else if (!s.empty() && s[0] == ':') {
+        return false;
+    }
+
+    while (!s.empty()) {
+        uint8_t* buf = compressed ? tail : head;
+        size_t& n = compressed ? ntail : nhead;
+        size_t colon = s.find(':');
+        std::string_view group = s.substr(0, colon);
+
+        if (group.find('.') != std::string_view::npos) {
+            // embedded IPv4 must be the last group
+            if (colon != std::string_view::npos || n + 4 > 16) return false;
+            if (!parseIPv4(group, buf + n)) return false;
+            n += 4;
+            s = std::string_view();
+            break;
+        }
+        if (group.empty() || group.size() > 4 || n + 2 > 16) return false;
+        unsigned v = 0;
+        auto res = std::from_chars(group.data(), group.data() + group.size(), v, 16);
+        if (res.ec != std::errc() || res.ptr != group.data() + group.size()) return false;
+        buf[n++] = static_cast<uint8_t>(v >> 8);
+        buf[n++] = static_cast<uint8_t>(v & 0xff);
+
+        if (colon == std::string_view::npos) {
+            s = std::string_view();
+        } else if (s.substr(colon, 2) == "::") {
+            if (compressed) return false;
+            compressed = true;
+            s.remove_prefix(colon + 2);
+        } else {
+            s.remove_prefix(colon + 1);
+            if (s.empty()) return false; // trailing single colon
+        }
+    }
+
+    if (compressed) {
+        if (nhead + ntail > 14) return false;
+    } else if (nhead != 16) {
+        return false;
+    }
+    std::memset(out, 0, 16);
+    std::memcpy(out, head, nhead);
+    std::memcpy(out + 16 - ntail, tail, ntail);
+    return true;
+}
+
+} // namespace
+
+bool parsePrefixShard(std::string_view text, PrefixShard& out) {
+    const size_t slash = text.find('/');
+    if (slash == std::string_view::npos) return false;
+    unsigned index = 0, count = 0;
+    auto a = std::from_chars(text.data(), text.data() + slash, index);
+    auto b = std::from_chars(text.data() + slash + 1, text.data() + text.size(), count);
+    if (a.ec != std::errc() || a.ptr != text.data() + slash || b.ec != std::errc() ||
+        b.ptr != text.data() + text.size() || index < 1 || index > count) {
+        return false;
+    }
+    out.index = index;
+    out.count = count;
+    return true;
+}
+
+uint64_t prefixShardHash(const Prefix& p) {
+    // FNV-1a over the significant bytes
+    uint64_t h = 1469598103934665603ull;
+    const size_t n = p.ipv6 ? 16 : 4;
+    for (size_t i = 0; i < n; ++i) {
+        h ^= p.addr[i];
+        h *= 1099511628211ull;
+    }
+    h ^= static_cast<uint64_t>(p.length) | (p.ipv6 ? 0x100u : 0u);
+    h *= 1099511628211ull;
+    return h;
+}
+
+bool parsePrefix(std::string_view text, Prefix& out) {
+    size_t slash = text.find('/');
+    if (slash == std::string_view::npos) return false;
+    std::string_view addr = text.substr(0, slash);
+    std::string_view len = text.substr(slash + 1);
+
+    out = Prefix();
+    if (addr.find(':') != std::string_view::npos) {
+        out.ipv6 = true;
+        return parseIPv6(addr, out.addr.data()) && parseLength(len, 128, out.length);
+    }
+    return parseIPv4(addr, out.addr.data()) && parseLength(len, 32, out.length);
+}
+
+bool parseAddress(std::string_view text, Prefix& out) {
+    out = Prefix();
+    if (text.find(':') != std::string_view::npos) {
+        out.ipv6 = true;
+        out.length = 128;
+        return parseIPv6(text, out.addr.data());
+    }
+    out.length = 32;
+    return parseIPv4(text, out.addr.data());
+}
+
+uint32_t PrefixTable::intern(std::string_view text) {
+    Prefix p;
+    if (!parsePrefix(text, p)) return kInvalid;
+    return intern(p, text);
+}
+
+uint32_t PrefixTable::intern(const Prefix& prefix, std::string_view text) {
+    auto it = _ids.find(prefix);
+    if (it != _ids.end()) return it->second;
+
+    uint32_t id = static_cast<uint32_t>(_prefixes.size());
+    _prefixes.push_back(prefix);
+    _texts.emplace_back(text);
+    _ids.emplace(prefix, id);
+    return id;
+}
+
+uint32_t PrefixTable::find(std::string_view text) const {
+    Prefix p;
+    if (!parsePrefix(text, p)) return kInvalid;
+    auto it = _ids.find(p);
+    return it == _ids.end() ? kInvalid : it->second;
+}
+
+std::vector<uint32_t> PrefixTable::sortedIds() const {
+    std::vector<uint32_t> ids(_prefixes.size());
+    for (uint32_t p = 0; p < ids.size(); ++p) ids[p] = p;
+    std::sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) {
+        const Prefix &x = _prefixes[a], &y = _prefixes[b];
+        if (x.ipv6 != y.ipv6) return y.ipv6;
+        if (x.addr != y.addr) return x.addr < y.addr;
+        if (x.length != y.length) return x.length < y.length;
+        return a < b;
+    });
+    return ids;
+}
@@ -0,0 +1,271 @@
+#include "RIBFile.h"
+#include "ASGraph.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+constexpr size_t kAlign = 8;
+
+size_t padded(size_t bytes) { return (bytes + kAlign - 1) & ~(kAlign - 1); }
+
+template <typename T>
+void writeArray(std::ofstream& out, const T* data, size_t count) {
+    const size_t bytes = count * sizeof(T);
+    if (bytes) out.write(reinterpret_cast<const char*>(data), bytes);
+    static const char zeros[kAlign] = {};
+    out.write(zeros, padded(bytes) - bytes);
+}
+
+// Hands out the arrays of the mapped file in order, checking each fits
+class Cursor {
+    const char* _p;
+    const char* _end;
+public:
+    Cursor(const char* p, const char* end) : _p(p), _end(end) {}
+
+    template <typename T>
+    bool take(const T*& out, uint64_t count) {
+        const size_t left = static_cast<size_t>(_end - _p);
+        if (count > left / sizeof(T) || padded(count * sizeof(T)) > left) return false;
+        out = reinterpret_cast<const T*>(_p);
+        _p += padded(count * sizeof(T));
+        return true;
+    }
+};
+
+void appendNumber(std::string& out, uint32_t value) {
+    char buf[16];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr);
+}
+
+}  // namespace
+
+void appendRIBRow(std::string& out, uint32_t asn, std::string_view prefix, const uint32_t* path, size_t path_len) {
+    appendNumber(out, asn);
+    out += ',';
+    out += prefix;
+    // Format AS-path as (a, b, c) with a trailing comma for single-element paths: (a,)
+    out += ",\"(";
+    for (size_t i = 0; i < path_len; ++i) {
+        if (i) out += ", ";
+        appendNumber(out, path[i]);
+    }
+    if (path_len == 1) out += ',';
+    out += ")\"\n";
+}
+
+bool ASGraph::writeRIBFile(const std::string& filename, const RIBDumpOptions& options) const {
+    RIBFileWriter writer(filename);
+    return visitRIBs(options, {&writer});
+}
+
+bool RIBFileWriter::begin(const ASGraph& g, const std::vector<uint32_t>& prefixes) {
+    _prefix_offsets.assign(1, 0);
+    _prefix_text.clear();
+    for (uint32_t p : prefixes) {
+        _prefix_text += g.prefixes().text(p);
+        _prefix_offsets.push_back(_prefix_text.size());
+    }
+    _asns.clear();
+    _asn_rows.assign(1, 0);
+    _row_prefix.clear();
+    _row_path.clear();
+    _path_offsets.assign(1, 0);
+    _path_cells.clear();
+    _path_first.clear();
+    _path_chain.clear();
+
+    _out.open(_filename, std::ios::binary);
+    if (!_out.is_open()) {
+        std::cerr << "Error: Could not open output file " << _filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void RIBFileWriter::route(uint32_t asn, uint32_t slot, const RouteEntry&, const std::vector<uint32_t>& path) {
+    // Routes come grouped by AS, so a new ASN starts the next run
+    if (_asns.empty() || _asns.back() != asn) {
+        _asns.push_back(asn);
+        _asn_rows.push_back(_row_prefix.size());
+    }
+    _row_prefix.push_back(slot);
+    _row_path.push_back(addPath(path));
+    _asn_rows.back() = _row_prefix.size();
+}
+
+uint32_t RIBFileWriter::addPath(const std::vector<uint32_t>& path) {
+    constexpr uint32_t kNone = UINT32_MAX;
+    uint64_t h = 1469598103934665603ull;
+    for (uint32_t asn : path) h = (h ^ asn) * 1099511628211ull;
+    auto it = _path_first.try_emplace(h, kNone).first;
+    for (uint32_t k = it->second; k != kNone; k = _path_chain[k]) {
+        if (std::equal(path.begin(), path.end(), _path_cells.begin() + _path_offsets[k],
+                       _path_cells.begin() + _path_offsets[k + 1])) {
+            return k;
+        }
+    }
+    const uint32_t id = static_cast<uint32_t>(_path_offsets.size() - 1);
+    _path_cells.insert(_path_cells.end(), path.begin(), path.end());
+    _path_offsets.push_back(_path_cells.size());
+    _path_chain.push_back(it->second);
+    it->second = id;
+    return id;
+}
+
+bool RIBFileWriter::finish() {
+    if (_path_offsets.size() - 1 >= UINT32_MAX) {
+        std::cerr << "Error: Too many distinct AS paths for a RIB file" << std::endl;
+        return false;
+    }
+    RIBFileHeader header{};
+    std::memcpy(header.magic, kRIBFileMagic, sizeof(header.magic));
+    header.version = kRIBFileVersion;
+    header.num_prefixes = static_cast<uint32_t>(_prefix_offsets.size() - 1);
+    header.num_asns = static_cast<uint32_t>(_asns.size());
+    header.num_rows = _row_prefix.size();
+    header.num_paths = _path_offsets.size() - 1;
+    header.path_cells = _path_cells.size();
+    header.prefix_bytes = _prefix_text.size();
+
+    writeArray(_out, &header, 1);
+    writeArray(_out, _prefix_offsets.data(), _prefix_offsets.size());
+    writeArray(_out, _prefix_text.data(), _prefix_text.size());
+    writeArray(_out, _asns.data(), _asns.size());
+    writeArray(_out, _asn_rows.data(), _asn_rows.size());
+    writeArray(_out, _row_prefix.data(), _row_prefix.size());
+    writeArray(_out, _row_path.data(), _row_path.size());
+    writeArray(_out, _path_offsets.data(), _path_offsets.size());
+    writeArray(_out, _path_cells.data(), _path_cells.size());
+    _out.close();
+
+    if (!_out) {
+        std::cerr << "Error: Failed writing RIB file " << _filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool RIBFile::open(const std::string& filename) {
+    close();
+    _path = filename;
+    if (!_file.open(filename)) {
+        std::cerr << "Error: Could not open RIB file " << filename << std::endl;
+        return false;
+    }
+    if (_file.size() < sizeof(_header)) {
+        std::cerr << "Error: RIB file " << filename << " is truncated" << std::endl;
+        close();
+        return false;
+    }
+    std::memcpy(&_header, _file.data(), sizeof(_header));
+    if (std::memcmp(_header.magic, kRIBFileMagic, sizeof(_header.magic)) != 0) {
+        std::cerr << "Error: " << filename << " is not a RIB file" << std::endl;
+        close();
+        return false;
+    }
+    if (_header.version != kRIBFileVersion) {
+        std::cerr << "Error: RIB file " << filename << " has version " << _header.version << ", expected "
+                  << kRIBFileVersion << std::endl;
+        close();
+        return false;
+    }
+
+    Cursor cur(_file.data() + padded(sizeof(_header)), _file.end());
+    bool ok = cur.take(_prefix_offsets, uint64_t(_header.num_prefixes) + 1) &&
+              cur.take(_prefix_text, _header.prefix_bytes) && cur.take(_asns, _header.num_asns) &&
+              cur.take(_asn_rows, uint64_t(_header.num_asns) + 1) && cur.take(_row_prefix, _header.num_rows) &&
+              cur.take(_row_path, _header.num_rows) && _header.num_paths < UINT64_MAX &&
+              cur.take(_path_offsets, _header.num_paths + 1) && cur.take(_path_asns, _header.path_cells);
+
+    // The dictionary and the ASN index are small next to the rows; check them
+    // here so lookups can trust them. Rows and paths are checked as they are read.
+    ok = ok && _prefix_offsets[0] == 0 && _prefix_offsets[_header.num_prefixes] == _header.prefix_bytes &&
+         _asn_rows[0] == 0 && _asn_rows[_header.num_asns] == _header.num_rows;
+    for (uint32_t c = 0; ok && c < _header.num_prefixes; ++c) ok = _prefix_offsets[c] <= _prefix_offsets[c + 1];
+    for (uint32_t a = 0; ok && a < _header.num_asns; ++a) {
+        ok = _asn_rows[a] <= _asn_rows[a + 1] && (a == 0 || _asns[a - 1] < _asns[a]);
+    }
+    for (uint32_t c = 0; ok && c < _header.num_prefixes; ++c) ok = _codes.emplace(prefixText(c), c).second;
+    if (!ok) {
+        std::cerr << "Error: RIB file " << filename << " is truncated or corrupt" << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void RIBFile::close() {
+    _file.close();
+    _header = RIBFileHeader{};
+    _codes.clear();
+}
+
+std::string_view RIBFile::prefixText(uint32_t code) const {
+    return std::string_view(_prefix_text + _prefix_offsets[code], _prefix_offsets[code + 1] - _prefix_offsets[code]);
+}
+
+uint32_t RIBFile::prefixCode(std::string_view text) const {
+    auto it = _codes.find(text);
+    return it == _codes.end() ? kNoPrefix : it->second;
+}
+
+uint32_t RIBFile::asnIndex(uint32_t asn) const {
+    return static_cast<uint32_t>(std::lower_bound(_asns, _asns + _header.num_asns, asn) - _asns);
+}
+
+bool RIBFile::row(uint32_t a, uint64_t r, RIBRow& out) const {
+    const uint32_t path = _row_path[r];
+    if (_row_prefix[r] >= _header.num_prefixes || path >= _header.num_paths) return false;
+    const uint64_t begin = _path_offsets[path], end = _path_offsets[path + 1];
+    if (begin > end || end > _header.path_cells || end - begin > UINT32_MAX) return false;
+    out = {_asns[a], _row_prefix[r], _path_asns + begin, static_cast<uint32_t>(end - begin)};
+    return true;
+}
+
+bool RIBFile::corrupt() const {
+    std::cerr << "Error: RIB file " << _path << " is corrupt" << std::endl;
+    return false;
+}
+
+bool RIBFile::find(uint32_t asn, uint32_t code, std::vector<uint32_t>& path) const {
+    const uint32_t a = asnIndex(asn);
+    if (a == _header.num_asns || _asns[a] != asn) return false;
+    const uint32_t *first = _row_prefix + _asn_rows[a], *last = _row_prefix + _asn_rows[a + 1];
+    const uint32_t *it = std::lower_bound(first, last, code);
+    if (it == last || *it != code) return false;
+    RIBRow out;
+    if (!row(a, static_cast<uint64_t>(it - _row_prefix), out)) return corrupt();
+    path.assign(out.path, out.path + out.path_len);
+    return true;
+}
+
+bool RIBFile::writeCSV(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open output file " << filename << std::endl;
+        return false;
+    }
+    std::string buf = "asn,prefix,as_path\n";
+    const bool ok = forEach(0, UINT32_MAX, [&](const RIBRow& r) {
+        appendRIBRow(buf, r.asn, prefixText(r.prefix), r.path, r.path_len);
+        if (buf.size() >= (1u << 20)) {
+            out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+            buf.clear();
+        }
+    });
+    out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    out.close();
+    if (!ok) return false;
+    if (!out) {
+        std::cerr << "Error: Could not write output file " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
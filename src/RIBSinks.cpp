@@ -0,0 +1,78 @@
+#include "RIBSinks.h"
+#include "RIBFile.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+// Flush the CSV buffer once it holds this much
+constexpr size_t kFlushBytes = 1 << 20;
+
+bool openOutput(std::ofstream& out, const std::string& filename) {
+    out.open(filename, std::ios::binary);
+    if (!out.is_open()) std::cerr << "Error: Could not open output file " << filename << std::endl;
+    return out.is_open();
+}
+
+bool closeOutput(std::ofstream& out, const std::string& filename) {
+    out.close();
+    if (!out) std::cerr << "Error: Could not write output file " << filename << std::endl;
+    return static_cast<bool>(out);
+}
+
+}  // namespace
+
+bool RIBCSVWriter::begin(const ASGraph& g, const std::vector<uint32_t>& prefixes) {
+    _texts.clear();
+    for (uint32_t p : prefixes) _texts.push_back(&g.prefixes().text(p));
+    if (!openOutput(_out, _filename)) return false;
+    _buf = "asn,prefix,as_path\n";
+    return true;
+}
+
+void RIBCSVWriter::route(uint32_t asn, uint32_t slot, const RouteEntry&, const std::vector<uint32_t>& path) {
+    appendRIBRow(_buf, asn, *_texts[slot], path.data(), path.size());
+    if (_buf.size() >= kFlushBytes) {
+        _out.write(_buf.data(), static_cast<std::streamsize>(_buf.size()));
+        _buf.clear();
+    }
+}
+
+bool RIBCSVWriter::finish() {
+    _out.write(_buf.data(), static_cast<std::streamsize>(_buf.size()));
+    _buf.clear();
+    return closeOutput(_out, _filename);
+}
+
+bool PrefixStatsSink::begin(const ASGraph& g, const std::vector<uint32_t>& prefixes) {
+    _texts.clear();
+    for (uint32_t p : prefixes) _texts.push_back(&g.prefixes().text(p));
+    _origins.assign(prefixes.size(), {});
+    _lengths.assign(prefixes.size(), {});
+    return openOutput(_origins_out, _origins_file) && openOutput(_lengths_out, _lengths_file);
+}
+
+void PrefixStatsSink::route(uint32_t asn, uint32_t slot, const RouteEntry&, const std::vector<uint32_t>& path) {
+    ++_origins[slot][path.empty() ? asn : path.back()];
+    std::vector<uint64_t> &lengths = _lengths[slot];
+    if (lengths.size() <= path.size()) lengths.resize(path.size() + 1, 0);
+    ++lengths[path.size()];
+}
+
+bool PrefixStatsSink::finish() {
+    _origins_out << "prefix,origin,ases\n";
+    _lengths_out << "prefix,path_length,ases\n";
+    std::vector<std::pair<uint32_t, uint64_t>> origins;
+    for (size_t slot = 0; slot < _texts.size(); ++slot) {
+        const std::string &prefix = *_texts[slot];
+        origins.assign(_origins[slot].begin(), _origins[slot].end());
+        std::sort(origins.begin(), origins.end());
+        for (const auto &[origin, ases] : origins) _origins_out << prefix << ',' << origin << ',' << ases << '\n';
+        for (size_t len = 0; len < _lengths[slot].size(); ++len) {
+            if (_lengths[slot][len]) _lengths_out << prefix << ',' << len << ',' << _lengths[slot][len] << '\n';
+        }
+    }
+    const bool origins_ok = closeOutput(_origins_out, _origins_file);
+    return closeOutput(_lengths_out, _lengths_file) && origins_ok;
+}
@@ -0,0 +1,180 @@
+#include "RIBStore.h"
+
+#include <algorithm>
+
+uint32_t PathPool::append(const std::vector<uint32_t>& path) {
+    // Cells point towards the origin, so build from the last ASN
+    uint32_t head = kEnd;
+    for (auto it = path.rbegin(); it != path.rend(); ++it) head = push(*it, head);
+    return head;
+}
+
+void PathPool::materialize(uint32_t path, std::vector<uint32_t>& out) const {
+    out.clear();
+    for (uint32_t c = path; c != kEnd; c = _cells[c].rest) out.push_back(_cells[c].asn);
+}
+
+void RouteColumns::reset(size_t n) {
+    // Only `rel` decides whether a row holds a route
+    rel.assign(n, 0);
+    len.resize(n);
+    next_hop.resize(n);
+    path.resize(n);
+}
+
+void RouteColumns::resize(size_t n) {
+    rel.resize(n, 0);
+    len.resize(n);
+    next_hop.resize(n);
+    path.resize(n);
+}
+
+void RouteColumns::insert(size_t row, const RouteEntry& e) {
+    rel.insert(rel.begin() + row, e.rel);
+    len.insert(len.begin() + row, e.len);
+    next_hop.insert(next_hop.begin() + row, e.next_hop);
+    path.insert(path.begin() + row, e.path);
+}
+
+bool PrefixRIB::find(uint32_t node, RouteEntry& out) const {
+    size_t row;
+    if (_dense) {
+        if (node >= _cols.size() || _cols.rel[node] == 0) return false;
+        row = node;
+    } else {
+        auto it = std::lower_bound(_members.begin(), _members.end(), node);
+        if (it == _members.end() || *it != node) return false;
+        row = static_cast<size_t>(it - _members.begin());
+    }
+    out = _cols.get(row);
+    return true;
+}
+
+void PrefixRIB::set(uint32_t node, const RouteEntry& e, size_t num_nodes) {
+    if (!_dense) {
+        auto it = std::lower_bound(_members.begin(), _members.end(), node);
+        size_t row = static_cast<size_t>(it - _members.begin());
+        if (it != _members.end() && *it == node) {
+            _cols.put(row, e);
+            return;
+        }
+        _members.insert(it, node);
+        _cols.insert(row, e);
+        ++_count;
+        if (_count * kDenseFraction > num_nodes) makeDense(num_nodes);
+        return;
+    }
+
+    if (node >= _cols.size()) _cols.resize(std::max<size_t>(num_nodes, node + 1));
+    if (_cols.rel[node] == 0) ++_count;
+    _cols.put(node, e);
+}
+
+void PrefixRIB::erase(uint32_t node) {
+    if (_dense) {
+        if (node >= _cols.size() || _cols.rel[node] == 0) return;
+        _cols.rel[node] = 0;
+        --_count;
+        return;
+    }
+    auto it = std::lower_bound(_members.begin(), _members.end(), node);
+    if (it == _members.end() || *it != node) return;
+    size_t row = static_cast<size_t>(it - _members.begin());
+    _members.erase(it);
+    _cols.rel.erase(_cols.rel.begin() + row);
+    _cols.len.erase(_cols.len.begin() + row);
+    _cols.next_hop.erase(_cols.next_hop.begin() + row);
+    _cols.path.erase(_cols.path.begin() + row);
+    --_count;
+}
+
+size_t PrefixRIB::removeSeeds(uint32_t node) {
+    size_t before = _seeds.size();
+    _seeds.erase(std::remove_if(_seeds.begin(), _seeds.end(), [&](const SeedRoute& s) { return s.node == node; }),
+                 _seeds.end());
+    return before - _seeds.size();
+}
+
+void PrefixRIB::clearRoutes() {
+    // A seed's path is appended whole, so its head is its highest cell and
+    // everything it uses lies below it. When the seeds were added before any
+    // propagation their cells are exactly the bottom of the pool and truncating
+    // drops every propagated cell.
+    size_t keep = 0, seed_cells = 0;
+    std::vector<uint32_t> path;
+    for (const SeedRoute &s : _seeds) {
+        if (s.route.path == PathPool::kEnd) continue;
+        keep = std::max<size_t>(keep, s.route.path + 1);
+        _paths.materialize(s.route.path, path);
+        seed_cells += path.size();
+    }
+    if (keep == seed_cells) {
+        _paths.truncate(keep);
+    } else {
+        // A seed announced after propagation sits above propagated cells;
+        // copy the seed paths into a fresh pool so those cells are released
+        PathPool compact;
+        for (SeedRoute &s : _seeds) {
+            if (s.route.path == PathPool::kEnd) continue;
+            _paths.materialize(s.route.path, path);
+            s.route.path = compact.append(path);
+        }
+        _paths = std::move(compact);
+    }
+
+    _cols.reset(0);
+    _members.clear();
+    _count = 0;
+    _dense = false;
+}
+
+void PrefixRIB::makeDense(size_t num_nodes) {
+    RouteColumns dense;
+    dense.reset(num_nodes);
+    for (size_t row = 0; row < _members.size(); ++row) dense.put(_members[row], _cols.get(row));
+    _cols = std::move(dense);
+    _members.clear();
+    _members.shrink_to_fit();
+    _dense = true;
+}
+
+void PrefixRIB::scatter(RouteColumns& work, size_t num_nodes) const {
+    work.reset(num_nodes);
+    if (_dense) {
+        size_t n = std::min(num_nodes, _cols.size());
+        std::copy_n(_cols.rel.begin(), n, work.rel.begin());
+        std::copy_n(_cols.len.begin(), n, work.len.begin());
+        std::copy_n(_cols.next_hop.begin(), n, work.next_hop.begin());
+        std::copy_n(_cols.path.begin(), n, work.path.begin());
+    } else {
+        for (size_t row = 0; row < _members.size(); ++row) {
+            if (_members[row] < num_nodes) work.put(_members[row], _cols.get(row));
+        }
+    }
+}
+
+void PrefixRIB::gather(RouteColumns& work) {
+    const size_t n = work.size();
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) count += work.rel[i] != 0;
+    _count = count;
+
+    if (count * kDenseFraction > n) {
+        std::swap(_cols, work);
+        _members.clear();
+        _dense = true;
+        return;
+    }
+
+    _dense = false;
+    _members.clear();
+    _cols.reset(0);
+    for (size_t i = 0; i < n; ++i) {
+        if (work.rel[i] == 0) continue;
+        _members.push_back(static_cast<uint32_t>(i));
+        _cols.rel.push_back(work.rel[i]);
+        _cols.len.push_back(work.len[i]);
+        _cols.next_hop.push_back(work.next_hop[i]);
+        _cols.path.push_back(work.path[i]);
+    }
+}
@@ -0,0 +1,143 @@
+#include "ASGraph.h"
+#include "RIBFile.h"
+#include "RIBSinks.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+// ASes formatted per task; large enough that a task is mostly formatting
+constexpr size_t kChunkASes = 256;
+
+}  // namespace
+
+void ASGraph::dumpRIBsToCSV(const std::string& filename, const RIBDumpOptions& options) const {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open output file " << filename << std::endl;
+        return;
+    }
+
+    out << "asn,prefix,as_path\n";
+
+    const std::vector<uint32_t> order = outputNodes(options);
+    const std::vector<uint32_t> prefixes = outputPrefixes(options);
+    std::vector<const PrefixRIB*> ribs(prefixes.size());
+    for (size_t k = 0; k < prefixes.size(); ++k) ribs[k] = &routesOf(prefixes[k]);
+
+    // Rows of the ASes order[begin, end) appended to `buf`
+    auto format = [&](size_t begin, size_t end, std::string& buf, std::vector<uint32_t>& as_path) {
+        for (size_t k = begin; k < end; ++k) {
+            const uint32_t n = order[k];
+            for (size_t r = 0; r < ribs.size(); ++r) {
+                RouteEntry route;
+                if (!ribs[r]->find(n, route)) continue;
+                ribs[r]->paths().materialize(route.path, as_path);
+                appendRIBRow(buf, _nodes[n]._asn, _prefixes.text(prefixes[r]), as_path.data(), as_path.size());
+            }
+        }
+    };
+
+    const size_t chunks = (order.size() + kChunkASes - 1) / kChunkASes;
+    const unsigned threads = options.threads ? options.threads : ThreadPool::defaultThreads();
+    if (threads <= 1 || chunks <= 1) {
+        std::string buf;
+        std::vector<uint32_t> as_path;
+        for (size_t c = 0; c < chunks; ++c) {
+            buf.clear();
+            format(c * kChunkASes, std::min(order.size(), (c + 1) * kChunkASes), buf, as_path);
+            out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        }
+    } else {
+        // Batches of chunks are formatted concurrently, then written in order;
+        // a batch bounds the memory held to a few chunks per thread
+        ThreadPool pool(static_cast<unsigned>(std::min<size_t>(threads, chunks)));
+        const size_t batch = static_cast<size_t>(pool.size()) * 4;
+        std::vector<std::string> bufs(batch);
+        for (size_t first = 0; first < chunks; first += batch) {
+            const size_t count = std::min(batch, chunks - first);
+            std::atomic<size_t> next{0};
+            std::vector<std::future<void>> done;
+            for (unsigned t = 0; t < pool.size(); ++t) {
+                done.push_back(pool.submit([&]() {
+                    std::vector<uint32_t> as_path;
+                    for (size_t b; (b = next.fetch_add(1)) < count;) {
+                        const size_t c = first + b;
+                        bufs[b].clear();
+                        format(c * kChunkASes, std::min(order.size(), (c + 1) * kChunkASes), bufs[b], as_path);
+                    }
+                }));
+            }
+            for (auto &f : done) f.get();
+            for (size_t b = 0; b < count; ++b) out.write(bufs[b].data(), static_cast<std::streamsize>(bufs[b].size()));
+        }
+    }
+
+    out.close();
+    if (!out) std::cerr << "Error: Could not write output file " << filename << std::endl;
+}
+
+bool ASGraph::visitRIBs(const RIBDumpOptions& options, const std::vector<RIBSink*>& sinks) const {
+    const std::vector<uint32_t> order = outputNodes(options);
+    const std::vector<uint32_t> prefixes = outputPrefixes(options);
+    for (RIBSink *sink : sinks) {
+        if (!sink->begin(*this, prefixes)) return false;
+    }
+
+    std::vector<const PrefixRIB*> ribs(prefixes.size());
+    for (size_t k = 0; k < prefixes.size(); ++k) ribs[k] = &routesOf(prefixes[k]);
+    std::vector<uint32_t> as_path;
+    for (uint32_t n : order) {
+        for (uint32_t slot = 0; slot < ribs.size(); ++slot) {
+            RouteEntry route;
+            if (!ribs[slot]->find(n, route)) continue;
+            ribs[slot]->paths().materialize(route.path, as_path);
+            for (RIBSink *sink : sinks) sink->route(_nodes[n]._asn, slot, route, as_path);
+        }
+    }
+
+    bool ok = true;
+    for (RIBSink *sink : sinks) ok = sink->finish() && ok;
+    return ok;
+}
+
+std::vector<uint32_t> ASGraph::outputNodes(const RIBDumpOptions& options) const {
+    std::vector<uint32_t> order;
+    if (options.asns) {
+        for (uint32_t asn : *options.asns) {
+            auto it = _index.find(asn);
+            if (it != _index.end()) order.push_back(it->second);
+        }
+    } else {
+        order.resize(_nodes.size());
+        for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return _nodes[a]._asn < _nodes[b]._asn; });
+    order.erase(std::unique(order.begin(), order.end()), order.end());
+    return order;
+}
+
+std::vector<uint32_t> ASGraph::outputPrefixes(const RIBDumpOptions& options) const {
+    std::vector<uint32_t> prefixes;
+    if (options.sort_prefixes) {
+        prefixes = _prefixes.sortedIds();
+    } else {
+        prefixes.resize(_prefixes.size());
+        for (uint32_t p = 0; p < prefixes.size(); ++p) prefixes[p] = p;
+    }
+    // Prefixes interned after the last seed have no RIB (and no routes)
+    std::vector<uint8_t> selected(_ribs.size(), !options.prefixes);
+    if (options.prefixes) {
+        for (uint32_t p : *options.prefixes) {
+            if (p < selected.size()) selected[p] = 1;
+        }
+    }
+    prefixes.erase(std::remove_if(prefixes.begin(), prefixes.end(),
+                                  [&](uint32_t p) { return p >= selected.size() || !selected[p]; }),
+                   prefixes.end());
+    return prefixes;
+}
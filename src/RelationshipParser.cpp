@@ -0,0 +1,66 @@
+#include "RelationshipParser.h"
+
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Parse the '|'-terminated field starting at `p` into `value`, advancing `p`
+// past the separator. `last` allows the field to end at `end` instead of '|'.
+template <typename T>
+bool parseField(const char*& p, const char* end, T& value, bool last) {
+    const char* sep = static_cast<const char*>(std::memchr(p, '|', end - p));
+    const char* field_end = sep ? sep : end;
+    if (!sep && !last) return false;
+
+    const char* b = p;
+    const char* e = field_end;
+    while (b < e && isBlank(*b)) ++b;
+    while (e > b && isBlank(e[-1])) --e;
+    if (b == e) return false;
+
+    auto res = std::from_chars(b, e, value);
+    if (res.ec != std::errc() || res.ptr != e) return false;
+
+    p = sep ? sep + 1 : end;
+    return true;
+}
+
+} // namespace
+
+bool parseRelationshipLine(const char* begin, const char* end, ASRelationship& out) {
+    const char* p = begin;
+    if (!parseField(p, end, out.asn1, false)) return false;
+    if (!parseField(p, end, out.asn2, false)) return false;
+    if (!parseField(p, end, out.rel, true)) return false;
+    return true;
+}
+
+void parseRelationships(const char* begin, const char* end,
+                        std::vector<ASRelationship>& edges,
+                        ParseReport& report,
+                        size_t first_line) {
+    size_t line_no = first_line;
+    const char* p = begin;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* line_end = nl ? nl : end;
+
+        const char* q = p;
+        while (q < line_end && isBlank(*q)) ++q;
+        if (q < line_end && *q != '#') {
+            ASRelationship rel;
+            if (parseRelationshipLine(p, line_end, rel)) {
+                edges.push_back(rel);
+            } else {
+                report.malformed_lines.push_back(line_no);
+            }
+        }
+
+        ++report.lines;
+        ++line_no;
+        p = nl ? nl + 1 : end;
+    }
+}
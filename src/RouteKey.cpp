@@ -0,0 +1,81 @@
+#include "RouteKey.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ROUTEKEY_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace RouteKey {
+
+uint64_t minKeyScalar(const uint64_t* keys, size_t n) {
+    // Four independent accumulators; the selects compile to cmov
+    uint64_t m0 = kNone, m1 = kNone, m2 = kNone, m3 = kNone;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        m0 = keys[i] < m0 ? keys[i] : m0;
+        m1 = keys[i + 1] < m1 ? keys[i + 1] : m1;
+        m2 = keys[i + 2] < m2 ? keys[i + 2] : m2;
+        m3 = keys[i + 3] < m3 ? keys[i + 3] : m3;
+    }
+    for (; i < n; ++i) m0 = keys[i] < m0 ? keys[i] : m0;
+    m0 = m1 < m0 ? m1 : m0;
+    m2 = m3 < m2 ? m3 : m2;
+    return m2 < m0 ? m2 : m0;
+}
+
+#ifdef ROUTEKEY_AVX2
+// AVX2 has no unsigned 64-bit compare: flipping the sign bit maps unsigned
+// order onto signed order, so compare the biased lanes and blend.
+__attribute__((target("avx2"))) static uint64_t minKeyAVX2(const uint64_t* keys, size_t n) {
+    const __m256i bias = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+    __m256i m0 = _mm256_set1_epi64x(-1), m1 = m0;  // kNone
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i + 4));
+        __m256i ga = _mm256_cmpgt_epi64(_mm256_xor_si256(m0, bias), _mm256_xor_si256(a, bias));
+        __m256i gb = _mm256_cmpgt_epi64(_mm256_xor_si256(m1, bias), _mm256_xor_si256(b, bias));
+        m0 = _mm256_blendv_epi8(m0, a, ga);
+        m1 = _mm256_blendv_epi8(m1, b, gb);
+    }
+    __m256i g = _mm256_cmpgt_epi64(_mm256_xor_si256(m0, bias), _mm256_xor_si256(m1, bias));
+    m0 = _mm256_blendv_epi8(m0, m1, g);
+
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), m0);
+    uint64_t m = minKeyScalar(lanes, 4);
+    uint64_t tail = minKeyScalar(keys + i, n - i);
+    return tail < m ? tail : m;
+}
+
+static bool hasAVX2() {
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+#endif
+
+uint64_t minKey(const uint64_t* keys, size_t n) {
+#ifdef ROUTEKEY_AVX2
+    // Below two vectors the setup costs more than it saves
+    if (n >= 8 && hasAVX2()) return minKeyAVX2(keys, n);
+#endif
+    return minKeyScalar(keys, n);
+}
+
+bool vectorized() {
+#ifdef ROUTEKEY_AVX2
+    return hasAVX2();
+#else
+    return false;
+#endif
+}
+
+size_t argMin(const uint64_t* keys, size_t n) {
+    const uint64_t m = minKey(keys, n);
+    for (size_t i = 0; i < n; ++i) {
+        if (keys[i] == m) return i;
+    }
+    return n;
+}
+
+}  // namespace RouteKey
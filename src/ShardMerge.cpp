@@ -0,0 +1,203 @@
+#include "ShardMerge.h"
+
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+constexpr const char* kManifestMagic = "bgp_simulator shard manifest 1";
+
+// Directory part of `path`, including the trailing slash ("" if none)
+std::string directoryOf(const std::string& path) {
+    const size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+// "<key> <value>" line of a manifest
+bool readField(std::istream& in, const char* key, std::string& value) {
+    std::string line;
+    if (!std::getline(in, line)) return false;
+    const size_t n = std::char_traits<char>::length(key);
+    if (line.compare(0, n, key) != 0 || line.size() <= n || line[n] != ' ') return false;
+    value = line.substr(n + 1);
+    return true;
+}
+
+bool parseCount(std::string_view text, uint64_t& out) {
+    auto res = std::from_chars(text.data(), text.data() + text.size(), out);
+    return res.ec == std::errc() && res.ptr == text.data() + text.size();
+}
+
+// One shard's CSV during the merge
+struct ShardReader {
+    std::ifstream in;
+    std::string line;
+    std::string path;
+    uint64_t rows = 0;
+    uint32_t asn = 0;
+    uint32_t ordinal = 0;
+};
+
+}  // namespace
+
+bool writeShardManifest(const ASGraph& g, const std::string& ribs, const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open shard manifest " << path << std::endl;
+        return false;
+    }
+    const PrefixShard &shard = g.prefixShard();
+    out << kManifestMagic << '\n';
+    out << "shard " << shard.index << '/' << shard.count << '\n';
+    out << "ribs " << ribs << '\n';
+    out << "rows " << g.routeCount() << '\n';
+    out << "prefixes " << g.prefixes().size() << '\n';
+    for (uint32_t p = 0; p < g.prefixes().size(); ++p) out << g.prefixOrdinal(p) << ' ' << g.prefixes().text(p) << '\n';
+    return static_cast<bool>(out);
+}
+
+bool readShardManifest(const std::string& path, ShardManifest& out) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "Error: Could not open shard manifest " << path << std::endl;
+        return false;
+    }
+    out = ShardManifest();
+    std::string line, shard, rows, count;
+    bool ok = std::getline(in, line) && line == kManifestMagic && readField(in, "shard", shard) &&
+              parsePrefixShard(shard, out.shard) && readField(in, "ribs", out.ribs) && readField(in, "rows", rows) &&
+              parseCount(rows, out.rows) && readField(in, "prefixes", count);
+    uint64_t prefixes = 0;
+    ok = ok && parseCount(count, prefixes);
+    for (uint64_t k = 0; ok && k < prefixes; ++k) {
+        ok = static_cast<bool>(std::getline(in, line));
+        const size_t space = ok ? line.find(' ') : std::string::npos;
+        uint64_t ordinal = 0;
+        ok = space != std::string::npos && parseCount(std::string_view(line).substr(0, space), ordinal) &&
+             ordinal <= UINT32_MAX;
+        if (ok) out.prefixes.emplace_back(static_cast<uint32_t>(ordinal), line.substr(space + 1));
+    }
+    if (!ok) std::cerr << "Error: Shard manifest " << path << " is malformed" << std::endl;
+    return ok;
+}
+
+bool mergeShards(const std::vector<std::string>& manifests, const std::string& out) {
+    std::vector<ShardManifest> shards(manifests.size());
+    for (size_t s = 0; s < manifests.size(); ++s) {
+        if (!readShardManifest(manifests[s], shards[s])) return false;
+    }
+    if (shards.empty()) {
+        std::cerr << "Error: No shard manifests to merge" << std::endl;
+        return false;
+    }
+
+    // Every shard of one split exactly once
+    const unsigned count = shards[0].shard.count;
+    std::vector<uint8_t> present(count + 1, 0);
+    for (size_t s = 0; s < shards.size(); ++s) {
+        const PrefixShard &shard = shards[s].shard;
+        if (shard.count != count || present[shard.index]) {
+            std::cerr << "Error: " << manifests[s] << " holds shard " << shard.index << '/' << shard.count
+                      << ", which does not fit the other manifests" << std::endl;
+            return false;
+        }
+        present[shard.index] = 1;
+    }
+    for (unsigned i = 1; i <= count; ++i) {
+        if (!present[i]) {
+            std::cerr << "Error: Shard " << i << '/' << count << " is missing" << std::endl;
+            return false;
+        }
+    }
+
+    // Prefix text -> ordinal over all shards (the views point into `shards`)
+    std::unordered_map<std::string_view, uint32_t> ordinals;
+    for (const ShardManifest &m : shards) {
+        for (const auto &[ordinal, text] : m.prefixes) {
+            if (!ordinals.emplace(text, ordinal).second) {
+                std::cerr << "Error: Prefix " << text << " appears in more than one shard" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    std::vector<ShardReader> readers(shards.size());
+    auto advance = [&](ShardReader& r) {
+        if (!std::getline(r.in, r.line)) return false;
+        // asn,prefix,... with a prefix from the manifests
+        const size_t comma = r.line.find(',');
+        const size_t next = comma == std::string::npos ? comma : r.line.find(',', comma + 1);
+        bool ok = next != std::string::npos;
+        if (ok) {
+            auto res = std::from_chars(r.line.data(), r.line.data() + comma, r.asn);
+            auto it = ordinals.find(std::string_view(r.line).substr(comma + 1, next - comma - 1));
+            ok = res.ec == std::errc() && res.ptr == r.line.data() + comma && it != ordinals.end();
+            if (ok) r.ordinal = it->second;
+        }
+        if (!ok) {
+            std::cerr << "Error: Unexpected row in " << r.path << ": " << r.line << std::endl;
+            return false;
+        }
+        ++r.rows;
+        return true;
+    };
+    // Orders the heap smallest (ASN, ordinal) first
+    auto later = [&](size_t a, size_t b) {
+        return readers[a].asn != readers[b].asn ? readers[a].asn > readers[b].asn
+                                                : readers[a].ordinal > readers[b].ordinal;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+
+    for (size_t s = 0; s < shards.size(); ++s) {
+        ShardReader &r = readers[s];
+        const std::string &ribs = shards[s].ribs;
+        r.path = !ribs.empty() && ribs[0] == '/' ? ribs : directoryOf(manifests[s]) + ribs;
+        r.in.open(r.path);
+        std::string header;
+        if (!r.in.is_open() || !std::getline(r.in, header)) {
+            std::cerr << "Error: Could not read shard output " << r.path << std::endl;
+            return false;
+        }
+        if (advance(r)) {
+            heap.push(s);
+        } else if (!r.in.eof()) {
+            return false;
+        }
+    }
+
+    std::ofstream csv(out);
+    if (!csv.is_open()) {
+        std::cerr << "Error: Could not open output file " << out << std::endl;
+        return false;
+    }
+    csv << "asn,prefix,as_path\n";
+    while (!heap.empty()) {
+        const size_t s = heap.top();
+        heap.pop();
+        ShardReader &r = readers[s];
+        csv << r.line << '\n';
+        const uint32_t asn = r.asn, ordinal = r.ordinal;
+        if (!advance(r)) {
+            if (!r.in.eof()) return false;
+            continue;
+        }
+        if (r.asn < asn || (r.asn == asn && r.ordinal <= ordinal)) {
+            std::cerr << "Error: Shard output " << r.path << " is not sorted" << std::endl;
+            return false;
+        }
+        heap.push(s);
+    }
+
+    for (size_t s = 0; s < shards.size(); ++s) {
+        if (readers[s].rows != shards[s].rows) {
+            std::cerr << "Error: Shard output " << readers[s].path << " has " << readers[s].rows << " rows, its manifest "
+                      << shards[s].rows << std::endl;
+            return false;
+        }
+    }
+    return static_cast<bool>(csv);
+}
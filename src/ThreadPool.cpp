@@ -0,0 +1,38 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = defaultThreads();
+    _workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        _workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _cv.notify_all();
+    for (auto& w : _workers) w.join();
+}
+
+unsigned ThreadPool::defaultThreads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+            // Drain remaining work before shutting down
+            if (_tasks.empty()) return;
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        task();
+    }
+}
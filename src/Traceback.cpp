@@ -0,0 +1,92 @@
+#include "Traceback.h"
+
+#include <atomic>
+#include <future>
+
+#include "BGP.h"
+#include "ThreadPool.h"
+
+namespace {
+
+// Working states next to the three outcomes while a destination is traced
+constexpr uint8_t kUnresolved = 3;
+constexpr uint8_t kOnChain = 4;
+
+}  // namespace
+
+TraceCounts Traceback::trace(const Prefix& destination, std::vector<TraceOutcome>& outcome) const {
+    const uint32_t n = static_cast<uint32_t>(_graph.size());
+    std::vector<uint8_t> state(n, kUnresolved);
+    std::vector<uint32_t> chain;
+    RouteEntry route;
+
+    for (uint32_t start = 0; start < n; ++start) {
+        if (state[start] != kUnresolved) continue;
+
+        // Walk next hops until an AS with a known outcome, an origin, a dead
+        // end, or an AS already on this chain (a loop)
+        chain.clear();
+        uint8_t result = static_cast<uint8_t>(TraceOutcome::Blackhole);
+        for (uint32_t node = start;;) {
+            if (state[node] != kUnresolved) {
+                if (state[node] != kOnChain) result = state[node];
+                break;
+            }
+            state[node] = kOnChain;
+            chain.push_back(node);
+            if (_graph.routeAt(node, destination, route) == PrefixTable::kInvalid) break;
+            if (BGP::relationshipOf(route.rel) == Relationship::Origin) {
+                result = static_cast<uint8_t>((route.rel & RouteEntry::kROVInvalid) ? TraceOutcome::Attacker
+                                                                                      : TraceOutcome::Legitimate);
+                break;
+            }
+            // A seeded path may name a next hop that is not in the graph;
+            // traffic handed to it goes nowhere
+            if (!_graph.findIndex(route.next_hop, node)) break;
+        }
+        for (uint32_t node : chain) state[node] = result;
+    }
+
+    TraceCounts counts;
+    outcome.resize(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        outcome[i] = static_cast<TraceOutcome>(state[i]);
+        switch (outcome[i]) {
+            case TraceOutcome::Legitimate: ++counts.legitimate; break;
+            case TraceOutcome::Attacker: ++counts.attacker; break;
+            case TraceOutcome::Blackhole: ++counts.blackhole; break;
+        }
+    }
+    return counts;
+}
+
+std::vector<TraceCounts> Traceback::run(const std::vector<Prefix>& destinations, unsigned threads,
+                                        std::vector<std::vector<TraceOutcome>>* outcomes) const {
+    std::vector<TraceCounts> counts(destinations.size());
+    if (outcomes) outcomes->assign(destinations.size(), {});
+
+    // Destinations are handed out one at a time; the RIBs are only read
+    ThreadPool pool(threads);
+    std::atomic<size_t> next{0};
+    std::vector<std::future<void>> done;
+    for (unsigned w = 0; w < pool.size(); ++w) {
+        done.push_back(pool.submit([&]() {
+            std::vector<TraceOutcome> local;
+            for (size_t d; (d = next.fetch_add(1)) < destinations.size();) {
+                std::vector<TraceOutcome> &out = outcomes ? (*outcomes)[d] : local;
+                counts[d] = trace(destinations[d], out);
+            }
+        }));
+    }
+    for (auto &f : done) f.get();
+    return counts;
+}
+
+const char* outcomeName(TraceOutcome outcome) {
+    switch (outcome) {
+        case TraceOutcome::Legitimate: return "legitimate";
+        case TraceOutcome::Attacker: return "attacker";
+        case TraceOutcome::Blackhole: return "blackhole";
+    }
+    return "unknown";
+}
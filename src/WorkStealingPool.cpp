@@ -0,0 +1,113 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+    _num_workers = threads ? threads : ThreadPool::defaultThreads();
+    _queues.reset(new Queue[_num_workers]);
+    _threads.reserve(_num_workers - 1);
+    for (unsigned id = 1; id < _num_workers; ++id) {
+        _threads.emplace_back([this, id]() { workerLoop(id); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& t : _threads) t.join();
+}
+
+void WorkStealingPool::parallelFor(size_t n, size_t grain, const std::function<void(size_t, size_t, unsigned)>& body) {
+    if (grain == 0) grain = 1;
+    if (n == 0) return;
+    if (n <= grain || _num_workers == 1) {
+        body(0, n, 0);
+        return;
+    }
+
+    // Deal the chunks out in contiguous blocks so each worker starts on
+    // neighboring indices
+    const size_t num_chunks = (n + grain - 1) / grain;
+    const size_t per_worker = (num_chunks + _num_workers - 1) / _num_workers;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (unsigned w = 0; w < _num_workers; ++w) {
+            std::lock_guard<std::mutex> qlock(_queues[w].mutex);
+            for (size_t c = w * per_worker; c < (w + 1) * per_worker && c < num_chunks; ++c) {
+                _queues[w].chunks.emplace_back(c * grain, std::min(n, (c + 1) * grain));
+            }
+        }
+        _remaining.store(num_chunks);
+        _body = &body;
+        _open = true;
+        ++_generation;
+    }
+    _wake.notify_all();
+
+    runChunks(0);
+
+    // Wait until every chunk has run and no worker can still pick up this job
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this]() { return _remaining.load() == 0 && _active == 0; });
+    _open = false;
+    _body = nullptr;
+}
+
+void WorkStealingPool::workerLoop(unsigned id) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [&]() { return _stop || _generation != seen; });
+            if (_stop) return;
+            seen = _generation;
+            if (!_open) continue;
+            ++_active;
+        }
+        runChunks(id);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --_active;
+        }
+        _done.notify_all();
+    }
+}
+
+void WorkStealingPool::runChunks(unsigned id) {
+    std::pair<size_t, size_t> chunk;
+    while (takeChunk(id, chunk)) {
+        (*_body)(chunk.first, chunk.second, id);
+        if (_remaining.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _done.notify_all();
+        }
+    }
+}
+
+bool WorkStealingPool::takeChunk(unsigned id, std::pair<size_t, size_t>& chunk) {
+    {
+        Queue& own = _queues[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.chunks.empty()) {
+            chunk = own.chunks.front();
+            own.chunks.pop_front();
+            return true;
+        }
+    }
+    // Steal from the back of the other queues, starting with the next worker
+    for (unsigned k = 1; k < _num_workers; ++k) {
+        Queue& victim = _queues[(id + k) % _num_workers];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
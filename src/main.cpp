@@ -1,20 +1,295 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <new>
 #include <string>
+#include <vector>
 #include "../include/ASGraph.h"
+#include "../include/GraphSnapshot.h"
+#include "../include/HijackTrials.h"
+#include "../include/RIBFile.h"
+#include "../include/RIBSinks.h"
+#include "../include/ShardMerge.h"
+#include "../include/Traceback.h"
 
-// g++ -std=c++17 -I include src/ASGraph.cpp src/BGP.cpp src/main.cpp -o bgp_simulator
+// g++ -std=c++17 -O2 -pthread -I include src/*.cpp -o bgp_simulator -lz -lbz2
 
-int main(int argc, char* argv[]) {
-    if (argc != 7) {
-        std::cerr << "Usage: " 
-                  << argv[0]
-                  << " --relationships <path> --announcements <path> --rov-asns <path>\n";
-        return 1;
+// Heap allocations made by the whole program, reported per stage with --stats.
+// Counting is off unless --stats is given, so the default path only reads a flag
+// that is never written after startup. When on, each thread bumps its own
+// cache-line sized stripe and the stripes are summed at stage boundaries. Every
+// form of operator new/delete is replaced so all heap blocks are counted.
+namespace {
+constexpr unsigned kAllocStripes = 64;
+struct alignas(64) AllocStripe { std::atomic<uint64_t> count{0}; };
+AllocStripe g_alloc_stripes[kAllocStripes];
+std::atomic<bool> g_count_allocations{false};
+std::atomic<unsigned> g_next_alloc_stripe{0};
+thread_local unsigned t_alloc_stripe = kAllocStripes; // assigned on first counted allocation
+
+uint64_t heapAllocations() {
+    uint64_t total = 0;
+    for (const auto &stripe : g_alloc_stripes) total += stripe.count.load(std::memory_order_relaxed);
+    return total;
+}
+
+// Take one block from the heap; `align` is 0 for the default alignment. The
+// replacements below all go through these two functions, which are kept out of
+// line so the compiler never pairs an inlined operator new with a raw free().
+[[gnu::noinline]] void* allocateBlock(std::size_t size, std::size_t align) noexcept {
+    if (g_count_allocations.load(std::memory_order_relaxed)) {
+        if (t_alloc_stripe == kAllocStripes) {
+            t_alloc_stripe = g_next_alloc_stripe.fetch_add(1, std::memory_order_relaxed) % kAllocStripes;
+        }
+        g_alloc_stripes[t_alloc_stripe].count.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (size == 0) size = 1;
+    if (align == 0) return std::malloc(size);
+    // aligned_alloc wants a size that is a multiple of the alignment
+    return std::aligned_alloc(align, (size + align - 1) / align * align);
+}
+[[gnu::noinline]] void releaseBlock(void* p) noexcept { std::free(p); }
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (void* p = allocateBlock(size, 0)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+    if (void* p = allocateBlock(size, 0)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t align) {
+    if (void* p = allocateBlock(size, static_cast<std::size_t>(align))) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size, std::align_val_t align) {
+    if (void* p = allocateBlock(size, static_cast<std::size_t>(align))) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocateBlock(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocateBlock(size, 0); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocateBlock(size, static_cast<std::size_t>(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocateBlock(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* p) noexcept { releaseBlock(p); }
+void operator delete[](void* p) noexcept { releaseBlock(p); }
+void operator delete(void* p, std::size_t) noexcept { releaseBlock(p); }
+void operator delete[](void* p, std::size_t) noexcept { releaseBlock(p); }
+void operator delete(void* p, std::align_val_t) noexcept { releaseBlock(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { releaseBlock(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { releaseBlock(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { releaseBlock(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { releaseBlock(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { releaseBlock(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { releaseBlock(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { releaseBlock(p); }
+
+static void printUsage(const char* prog) {
+    std::cerr << "Usage: "
+              << prog
+              << " --relationships <path> --announcements <path> --rov-asns <path>"
+              << " [--write-snapshot <path>] [--receive-mode streaming|queued]"
+              << " [--threads N] [--prefix-shards N] [--stats]\n"
+              << "       " << prog << " --relationships <path> --announcements <path> --rov-sweep <path> [options]\n"
+              << "       " << prog << " --relationships <path> --announcements <path> --trials N"
+              << " [--trial-seed S] [--adoption P,P,...] [--threads N]\n"
+              << "       " << prog << " ... --rov-asns <path> --traceback [--destinations <path>] [--per-as]\n"
+              << "       " << prog << " ... [--ribs-format csv|binary|none] [--sort-prefixes] [--monitor-asns <path>]"
+              << " [--monitor-prefixes <path>] [--prefix-stats]\n"
+              << "       " << prog << " --relationships <path> --write-snapshot <path>\n"
+              << "       " << prog << " --merge-shards <manifest>,<manifest>,...\n"
+              << "       " << prog << " --ribs-to-csv <ribs.bin>\n"
+              << "  --relationships accepts a CAIDA relationship file or a graph snapshot\n"
+              << "  --receive-mode queued keeps every offer until a step ends (reference mode)\n"
+              << "  --threads N propagates each rank and formats ribs.csv on N threads (0 = one per core);\n"
+              << "              output is unchanged\n"
+              << "  --prefix-shards N propagates N groups of prefixes concurrently (0 = one per core)\n"
+              << "  --rov-sweep lists one ROV ASNs file per line; the graph and announcements are loaded once\n"
+              << "              and scenario k is written to ribs_k.csv\n"
+              << "  --trials N runs N random ROV adoption trials per level (default 10,20,...,100 percent)\n"
+              << "             on --threads threads and writes the hijack success per level to trials.csv\n"
+              << "  --traceback follows next hops from every AS to each destination (an address or prefix per\n"
+              << "              line of --destinations, default: every prefix with an ROV-invalid seed) and\n"
+              << "              writes outcome counts to traceback.csv; --per-as also writes traceback_ases.csv\n"
+              << "  --shard i/N loads only shard i of N of the prefixes and writes ribs_shard_i_of_N.csv and\n"
+              << "              a .manifest next to it; --merge-shards merges the N shards into ribs.csv\n"
+              << "  --ribs-format binary writes the RIBs to ribs.bin (columnar, indexed by ASN and prefix)\n"
+              << "              instead of ribs.csv, none writes neither; --ribs-to-csv converts ribs.bin to ribs.csv\n"
+              << "  --sort-prefixes orders each AS's rows in ribs.csv by prefix instead of input order\n"
+              << "  --monitor-asns / --monitor-prefixes keep only the routes of the ASNs / prefixes listed one\n"
+              << "              per line in the file (in the RIBs and in --prefix-stats)\n"
+              << "  --prefix-stats counts per prefix the ASes choosing each origin and each AS-path length\n"
+              << "              (prefix_origins.csv, prefix_path_lengths.csv) in the same pass as the RIBs\n"
+              << "  --stats prints heap allocation counts per stage and propagation counters\n";
+}
+
+// Comma-separated adoption percentages for --adoption
+static bool parsePercents(const std::string& text, std::vector<unsigned>& out) {
+    out.clear();
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) end = text.size();
+        try {
+            size_t used = 0;
+            unsigned long p = std::stoul(text.substr(start, end - start), &used);
+            if (used != end - start || p > 100) return false;
+            out.push_back(static_cast<unsigned>(p));
+        } catch (...) {
+            return false;
+        }
+        start = end + 1;
     }
+    return !out.empty();
+}
 
+// Non-empty lines of a --rov-sweep list, trimmed
+static bool readSweepList(const std::string& path, std::vector<std::string>& out) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open ROV sweep list " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos) continue;
+        size_t end = line.find_last_not_of(" \t\r");
+        out.push_back(line.substr(start, end - start + 1));
+    }
+    if (out.empty()) {
+        std::cerr << "Error: ROV sweep list " << path << " names no files" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Non-empty lines of a --monitor-asns or --monitor-prefixes file, trimmed
+static bool readMonitorList(const std::string& path, std::vector<std::string>& out) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open monitor list " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos) continue;
+        size_t end = line.find_last_not_of(" \t\r");
+        out.push_back(line.substr(start, end - start + 1));
+    }
+    return true;
+}
+
+// Comma-separated file names for --merge-shards
+static std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) end = text.size();
+        if (end > start) out.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    return out;
+}
+
+// Addresses or prefixes, one per line, for --traceback; `labels` keeps the text
+static bool readDestinations(const std::string& path, std::vector<std::string>& labels,
+                             std::vector<Prefix>& destinations) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open destinations file " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    for (size_t line_no = 1; std::getline(file, line); ++line_no) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos) continue;
+        size_t end = line.find_last_not_of(" \t\r");
+        std::string text = line.substr(start, end - start + 1);
+        Prefix dest;
+        bool ok = text.find('/') != std::string::npos ? parsePrefix(text, dest) : parseAddress(text, dest);
+        if (!ok) {
+            std::cerr << "Warning: Skipping invalid destination on line " << line_no << " of " << path << std::endl;
+            continue;
+        }
+        labels.push_back(text);
+        destinations.push_back(dest);
+    }
+    return true;
+}
+
+// Trace `destinations` over the current RIBs and write the counts to `out`
+// (and per-AS outcomes to `per_as_out` if it is not empty)
+static bool writeTraceback(const ASGraph& g, const std::vector<std::string>& labels,
+                           const std::vector<Prefix>& destinations, unsigned threads, const std::string& out,
+                           const std::string& per_as_out) {
+    std::vector<std::vector<TraceOutcome>> outcomes;
+    Traceback traceback(g);
+    const std::vector<TraceCounts> counts =
+        traceback.run(destinations, threads, per_as_out.empty() ? nullptr : &outcomes);
+
+    std::ofstream csv(out);
+    if (!csv.is_open()) {
+        std::cerr << "Error: Could not open output file " << out << std::endl;
+        return false;
+    }
+    csv << "destination,legitimate,attacker,blackhole\n";
+    for (size_t d = 0; d < counts.size(); ++d) {
+        csv << labels[d] << ',' << counts[d].legitimate << ',' << counts[d].attacker << ',' << counts[d].blackhole
+            << '\n';
+    }
+    std::cout << "Wrote " << out << "\n";
+    if (per_as_out.empty()) return true;
+
+    std::ofstream ases(per_as_out);
+    if (!ases.is_open()) {
+        std::cerr << "Error: Could not open output file " << per_as_out << std::endl;
+        return false;
+    }
+    ases << "destination,asn,outcome\n";
+    for (size_t d = 0; d < outcomes.size(); ++d) {
+        for (uint32_t i = 0; i < outcomes[d].size(); ++i) {
+            ases << labels[d] << ',' << g.asnAt(i) << ',' << outcomeName(outcomes[d][i]) << '\n';
+        }
+    }
+    std::cout << "Wrote " << per_as_out << "\n";
+    return true;
+}
+
+int main(int argc, char* argv[]) {
     std::string relationships_path;
     std::string announcements_path;
     std::string rov_asns_path;
+    std::string rov_sweep_path;
+    std::string snapshot_out_path;
+    bool stats = false;
+    ReceiveMode receive_mode = ReceiveMode::Streaming;
+    unsigned threads = 1;
+    unsigned prefix_shards = 1;
+    HijackTrialConfig trial_config;
+    bool trials = false;
+    bool traceback = false;
+    bool traceback_per_as = false;
+    std::string destinations_path;
+    PrefixShard shard;
+    std::string merge_list;
+    RIBDumpOptions dump_options;
+    std::string ribs_format = "csv";
+    std::string ribs_to_csv;
+    std::string monitor_asns_path;
+    std::string monitor_prefixes_path;
+    bool prefix_stats = false;
 
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -25,49 +300,365 @@ int main(int argc, char* argv[]) {
             announcements_path = argv[++i];
         } else if (arg == "--rov-asns" && i + 1 < argc) {
             rov_asns_path = argv[++i];
+        } else if (arg == "--rov-sweep" && i + 1 < argc) {
+            rov_sweep_path = argv[++i];
+        } else if (arg == "--write-snapshot" && i + 1 < argc) {
+            snapshot_out_path = argv[++i];
+        } else if (arg == "--receive-mode" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "streaming") {
+                receive_mode = ReceiveMode::Streaming;
+            } else if (mode == "queued") {
+                receive_mode = ReceiveMode::Queued;
+            } else {
+                std::cerr << "Unknown receive mode: " << mode << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if ((arg == "--threads" || arg == "--prefix-shards") && i + 1 < argc) {
+            try {
+                unsigned n = static_cast<unsigned>(std::stoul(argv[++i]));
+                (arg == "--threads" ? threads : prefix_shards) = n;
+            } catch (...) {
+                std::cerr << "Invalid count for " << arg << ": " << argv[i] << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if ((arg == "--trials" || arg == "--trial-seed") && i + 1 < argc) {
+            try {
+                if (arg == "--trials") {
+                    trial_config.trials = static_cast<unsigned>(std::stoul(argv[++i]));
+                    trials = true;
+                } else {
+                    trial_config.seed = std::stoull(argv[++i]);
+                }
+            } catch (...) {
+                std::cerr << "Invalid count for " << arg << ": " << argv[i] << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--adoption" && i + 1 < argc) {
+            if (!parsePercents(argv[++i], trial_config.adoption_percents)) {
+                std::cerr << "Invalid adoption percentages: " << argv[i] << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--shard" && i + 1 < argc) {
+            if (!parsePrefixShard(argv[++i], shard)) {
+                std::cerr << "Invalid shard (expected i/N): " << argv[i] << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--merge-shards" && i + 1 < argc) {
+            merge_list = argv[++i];
+        } else if (arg == "--traceback") {
+            traceback = true;
+        } else if (arg == "--per-as") {
+            traceback_per_as = true;
+        } else if (arg == "--destinations" && i + 1 < argc) {
+            destinations_path = argv[++i];
+        } else if (arg == "--ribs-format" && i + 1 < argc) {
+            ribs_format = argv[++i];
+            if (ribs_format != "csv" && ribs_format != "binary" && ribs_format != "none") {
+                std::cerr << "Unknown RIB format: " << ribs_format << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--ribs-to-csv" && i + 1 < argc) {
+            ribs_to_csv = argv[++i];
+        } else if (arg == "--monitor-asns" && i + 1 < argc) {
+            monitor_asns_path = argv[++i];
+        } else if (arg == "--monitor-prefixes" && i + 1 < argc) {
+            monitor_prefixes_path = argv[++i];
+        } else if (arg == "--prefix-stats") {
+            prefix_stats = true;
+        } else if (arg == "--sort-prefixes") {
+            dump_options.sort_prefixes = true;
+        } else if (arg == "--stats") {
+            stats = true;
         } else {
             std::cerr << "Unknown or incomplete argument: " << arg << "\n";
+            printUsage(argv[0]);
             return 1;
         }
     }
 
+    // Merging only reads shard outputs
+    if (!merge_list.empty()) {
+        std::cout << "Merging shards..." << std::endl;
+        if (!mergeShards(splitList(merge_list), "ribs.csv")) return 1;
+        std::cout << "Wrote ribs.csv\n";
+        return 0;
+    }
+    // So does converting a binary RIB file
+    if (!ribs_to_csv.empty()) {
+        RIBFile ribs;
+        if (!ribs.open(ribs_to_csv) || !ribs.writeCSV("ribs.csv")) return 1;
+        std::cout << "Wrote ribs.csv (" << ribs.rows() << " routes)\n";
+        return 0;
+    }
+
+    // A snapshot-only run needs just the relationships; a simulation needs all
+    // three inputs, with either one ROV file or a sweep list; trials pick
+    // their own ROV sets
+    const bool sweep = !rov_sweep_path.empty();
+    const bool snapshot_only = announcements_path.empty() && rov_asns_path.empty() && !sweep && !trials &&
+                               !snapshot_out_path.empty();
+    const bool rov_ok = trials ? rov_asns_path.empty() && !sweep : rov_asns_path.empty() != rov_sweep_path.empty();
+    // Tracebacks read the propagated RIBs, which trials do not keep; a shard
+    // run writes one full CSV RIB dump, in the prefix order the merge expects
+    const bool traceback_ok = !traceback || !trials;
+    const bool shard_ok = shard.count <= 1 || (!trials && !sweep && !snapshot_only && ribs_format == "csv" &&
+                                               !dump_options.sort_prefixes && monitor_asns_path.empty() &&
+                                               monitor_prefixes_path.empty());
+    if (relationships_path.empty() || (!snapshot_only && (announcements_path.empty() || !rov_ok)) ||
+        !traceback_ok || !shard_ok) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<std::string> rov_sets;
+    if (sweep) {
+        if (!readSweepList(rov_sweep_path, rov_sets)) return 1;
+    } else {
+        rov_sets.push_back(rov_asns_path);
+    }
+
     std::cout << "Relationships: " << relationships_path << "\n";
-    std::cout << "Announcements: " << announcements_path << "\n";
-    std::cout << "ROV ASNs: " << rov_asns_path << "\n";
+    if (!snapshot_only) {
+        std::cout << "Announcements: " << announcements_path << "\n";
+        if (trials) {
+            std::cout << "ROV adoption trials: " << trial_config.trials << " per level, seed " << trial_config.seed << "\n";
+        } else if (sweep) {
+            std::cout << "ROV sweep: " << rov_sweep_path << " (" << rov_sets.size() << " scenarios)\n";
+        } else {
+            std::cout << "ROV ASNs: " << rov_asns_path << "\n";
+        }
+    }
+
+    // Allocations since the previous stage, printed with --stats
+    g_count_allocations.store(stats, std::memory_order_relaxed);
+    uint64_t allocations_mark = heapAllocations();
+    auto reportStage = [&](const char* stage) {
+        uint64_t now = heapAllocations();
+        if (stats) std::cout << "[stats] " << stage << ": " << (now - allocations_mark) << " heap allocations\n";
+        allocations_mark = now;
+    };
 
-    // Build graph from relationships
-    std::cout << "Building graph from file..." << std::endl;
     ASGraph g;
-    g.buildGraphFromFile(relationships_path);
-    std::cout << "Built graph from file." << std::endl;
+    g.setReceiveMode(receive_mode);
+    g.setThreads(threads);
+    dump_options.threads = threads;
+    g.setPrefixShards(prefix_shards);
+    if (isGraphSnapshot(relationships_path)) {
+        // Snapshot already holds the adjacency arrays and ranks
+        std::cout << "Loading graph snapshot..." << std::endl;
+        if (!g.loadSnapshot(relationships_path)) return 1;
+        std::cout << "Loaded graph snapshot." << std::endl;
+    } else {
+        // Build graph from relationships
+        std::cout << "Building graph from file..." << std::endl;
+        if (!g.buildGraphFromFile(relationships_path)) return 1;
+        std::cout << "Built graph from file." << std::endl;
+    }
 
     // Check for provider cycles and fail early if present
     std::cout << "Checking for cycles in graph..." << std::endl;
     if (g.hasProviderCycle()) {
-        std::cerr << "Error: provider/customer relationship cycle detected in " << relationships_path << std::endl;
+        const auto &cycle = g.providerCycle();
+        std::cerr << "Error: provider/customer relationship cycle detected in " << relationships_path
+                  << " among " << cycle.size() << " ASes:";
+        for (size_t i = 0; i < cycle.size() && i < 20; ++i) std::cerr << ' ' << cycle[i];
+        if (cycle.size() > 20) std::cerr << " ...";
+        std::cerr << std::endl;
         return 1;
     }
     std::cout << "Checked for cycles in graph." << std::endl;
+    reportStage("load graph");
+
+    if (!snapshot_out_path.empty()) {
+        std::cout << "Writing graph snapshot..." << std::endl;
+        if (!g.writeSnapshot(snapshot_out_path)) return 1;
+        std::cout << "Wrote " << snapshot_out_path << "\n";
+        if (snapshot_only) return 0;
+    }
+
+    if (trials) {
+        std::cout << "Seeding announcements from file..." << std::endl;
+        g.loadAnnouncementsFromFile(announcements_path);
+        std::cout << "Seeded announcements from file." << std::endl;
+        reportStage("load announcements");
+
+        std::cout << "Running trials..." << std::endl;
+        trial_config.threads = threads;
+        HijackTrialRunner runner(g);
+        const std::vector<HijackTrialSummary> summary = runner.run(trial_config);
+        std::cout << "Ran trials over " << runner.hijackedPrefixes().size() << " hijacked prefixes." << std::endl;
+        reportStage("trials");
+
+        const std::string out = "trials.csv";
+        std::ofstream csv(out);
+        if (!csv.is_open()) {
+            std::cerr << "Error: Could not open output file " << out << std::endl;
+            return 1;
+        }
+        csv << "adoption_percent,adopters,trials,mean_success,stddev,min,max\n";
+        std::cout << "adoption  adopters  mean success  stddev\n";
+        for (const HijackTrialSummary &s : summary) {
+            csv << s.adoption_percent << ',' << s.adopters << ',' << s.trials << ',' << s.mean << ',' << s.stddev << ','
+                << s.min << ',' << s.max << '\n';
+            std::cout << std::setw(7) << s.adoption_percent << "%  " << std::setw(8) << s.adopters << "  " << std::setw(12)
+                      << std::fixed << std::setprecision(4) << s.mean << "  " << s.stddev << std::defaultfloat << "\n";
+        }
+        std::cout << "Wrote " << out << "\n";
+        return 0;
+    }
 
-    // Load ROV-deploying ASNs
-    std::cout << "Loading ROVs from file..." << std::endl;
-    g.loadROVFromFile(rov_asns_path);
-    std::cout << "Loaded ROVs from file." << std::endl;
+    // Load ROV-deploying ASNs (a sweep loads them per scenario instead)
+    if (!sweep) {
+        std::cout << "Loading ROVs from file..." << std::endl;
+        g.loadROVFromFile(rov_asns_path);
+        std::cout << "Loaded ROVs from file." << std::endl;
+    }
 
     // Load announcements and seed into graph
+    if (shard.count > 1) {
+        std::cout << "Prefix shard: " << shard.index << "/" << shard.count << "\n";
+        g.setPrefixShard(shard);
+    }
     std::cout << "Seeding announcements from file..." << std::endl;
     g.loadAnnouncementsFromFile(announcements_path);
     std::cout << "Seeded announcements from file." << std::endl;
+    reportStage(sweep ? "load announcements" : "load ROV and announcements");
+
+    // Routes to keep in the output; the prefixes are known once the
+    // announcements are loaded
+    std::vector<std::string> monitored;
+    if (!monitor_asns_path.empty()) {
+        if (!readMonitorList(monitor_asns_path, monitored)) return 1;
+        dump_options.asns.emplace();
+        for (const std::string &text : monitored) {
+            size_t used = 0;
+            unsigned long asn = 0;
+            try {
+                asn = std::stoul(text, &used);
+            } catch (...) {
+                used = 0;
+            }
+            if (used != text.size() || asn > UINT32_MAX) {
+                std::cerr << "Warning: Skipping invalid ASN " << text << " in " << monitor_asns_path << std::endl;
+                continue;
+            }
+            dump_options.asns->push_back(static_cast<uint32_t>(asn));
+        }
+        std::cout << "Monitored ASNs: " << dump_options.asns->size() << "\n";
+    }
+    if (!monitor_prefixes_path.empty()) {
+        monitored.clear();
+        if (!readMonitorList(monitor_prefixes_path, monitored)) return 1;
+        dump_options.prefixes.emplace();
+        for (const std::string &text : monitored) {
+            uint32_t id = g.prefixes().find(text);
+            if (id == PrefixTable::kInvalid) {
+                std::cerr << "Warning: Monitored prefix " << text << " has no announcements" << std::endl;
+                continue;
+            }
+            dump_options.prefixes->push_back(id);
+        }
+        std::cout << "Monitored prefixes: " << dump_options.prefixes->size() << "\n";
+    }
 
-    // Run propagation
-    std::cout << "Propogating announcements..." << std::endl;
-    g.propagateAnnouncements();
-    std::cout << "Propogated announcements." << std::endl;
+    // Traceback destinations: the given file, or every prefix an invalid seed claims
+    std::vector<std::string> destination_labels;
+    std::vector<Prefix> destinations;
+    if (traceback) {
+        if (!destinations_path.empty()) {
+            if (!readDestinations(destinations_path, destination_labels, destinations)) return 1;
+        } else {
+            for (uint32_t p = 0; p < g.prefixes().size(); ++p) {
+                for (const SeedRoute &seed : g.seedsOf(p)) {
+                    if (!(seed.route.rel & RouteEntry::kROVInvalid)) continue;
+                    destination_labels.push_back(g.prefixes().text(p));
+                    destinations.push_back(g.prefixes().prefix(p));
+                    break;
+                }
+            }
+        }
+        std::cout << "Traceback destinations: " << destinations.size() << "\n";
+    }
 
-    // Dump resulting RIBs to ribs.csv
-    const std::string out = "ribs.csv";
-    g.dumpRIBsToCSV(out);
-    std::cout << "Wrote " << out << "\n";
+    for (size_t k = 0; k < rov_sets.size(); ++k) {
+        if (sweep) {
+            // Same graph and seeds; only the policies and routes start over
+            std::cout << "Scenario " << (k + 1) << "/" << rov_sets.size() << ": ROV ASNs " << rov_sets[k] << std::endl;
+            g.resetPolicies();
+            g.loadROVFromFile(rov_sets[k]);
+            g.resetRoutes();
+            reportStage("load ROV");
+        }
+
+        // Run propagation
+        std::cout << "Propogating announcements..." << std::endl;
+        g.propagateAnnouncements();
+        std::cout << "Propogated announcements." << std::endl;
+        reportStage("propagate");
+        if (stats) {
+            const PropagationStats &ps = g.propagationStats();
+            std::cout << "[stats] prefixes: " << ps.prefixes << " in " << ps.shards << " shard(s) (" << ps.shared
+                      << " more shared their routes), offers: " << ps.offers
+                      << ", steps: " << ps.steps << ", peak pending: " << ps.peak_pending << ", offer arena: " << ps.arena_bytes << " bytes, "
+                      << ps.arena_heap_blocks << " heap blocks\n";
+            if (ps.scanned != 0) {
+                std::cout << "[stats] ASes sending per phase: up " << ps.sent_up << ", across " << ps.sent_across
+                          << ", down " << ps.sent_down << " (of " << ps.scanned << " per phase)\n";
+            }
+        }
+
+        // Dump resulting RIBs to ribs.csv or ribs.bin (ribs_<k>.* in a sweep,
+        // or a shard's partial output and its manifest) and the per-prefix
+        // stats, all in one pass over the RIBs. A plain CSV dump keeps the
+        // threaded writer.
+        const std::string suffix = sweep ? "_" + std::to_string(k + 1) : "";
+        const std::string shard_name =
+            "ribs_shard_" + std::to_string(shard.index) + "_of_" + std::to_string(shard.count);
+        const std::string ext = ribs_format == "binary" ? ".bin" : ".csv";
+        const std::string out = shard.count > 1 ? shard_name + ext : "ribs" + suffix + ext;
+        std::vector<std::string> written;
+        std::vector<std::unique_ptr<RIBSink>> sinks;
+        if (ribs_format == "binary") {
+            sinks.push_back(std::make_unique<RIBFileWriter>(out));
+        } else if (ribs_format == "csv" && prefix_stats) {
+            sinks.push_back(std::make_unique<RIBCSVWriter>(out));
+        }
+        if (ribs_format != "none") written.push_back(out);
+        if (prefix_stats) {
+            written.push_back("prefix_origins" + suffix + ".csv");
+            written.push_back("prefix_path_lengths" + suffix + ".csv");
+            sinks.push_back(std::make_unique<PrefixStatsSink>(written[written.size() - 2], written.back()));
+        }
+        if (!sinks.empty()) {
+            std::vector<RIBSink*> pass;
+            for (auto &sink : sinks) pass.push_back(sink.get());
+            if (!g.visitRIBs(dump_options, pass)) return 1;
+        } else if (ribs_format == "csv") {
+            g.dumpRIBsToCSV(out, dump_options);
+        }
+        for (const std::string &file : written) std::cout << "Wrote " << file << "\n";
+        if (shard.count > 1) {
+            if (!writeShardManifest(g, out, shard_name + ".manifest")) return 1;
+            std::cout << "Wrote " << shard_name << ".manifest\n";
+        }
+        reportStage("write output");
+
+        if (traceback) {
+            std::cout << "Tracing destinations..." << std::endl;
+            if (!writeTraceback(g, destination_labels, destinations, threads, "traceback" + suffix + ".csv",
+                                traceback_per_as ? "traceback_ases" + suffix + ".csv" : "")) {
+                return 1;
+            }
+            reportStage("traceback");
+        }
+    }
 
     return 0;
 }
@@ -0,0 +1,59 @@
+#pragma once
+
+// Helpers shared by the test programs
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "../include/ASGraph.h"
+
+// Small LCG so generated topologies are the same on every platform
+struct TestRng {
+    uint32_t state;
+
+    explicit TestRng(uint32_t seed) : state(seed) {}
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+};
+
+// Shape of a random provider hierarchy built by buildHierarchy()
+struct HierarchySpec {
+    uint32_t num_ases;
+    uint32_t flat_below;       // AS a < flat_below may buy transit from any lower AS,
+    uint32_t spread_divisor;   // later ones from the first flat_below + a / spread_divisor
+    uint32_t max_providers;    // each AS above 1 gets 1..max_providers providers
+    uint32_t peer_links;       // random peer pairs tried (self pairs are skipped)
+    uint32_t asn_scale = 1;    // AS a gets ASN a * asn_scale
+};
+
+// Provider hierarchy with random peering. AS a only buys transit from
+// lower-numbered ASes, so there are no provider cycles. `rng` is left where
+// the topology ends, so callers can keep drawing seeds from it.
+inline void buildHierarchy(ASGraph& g, TestRng& rng, const HierarchySpec& spec) {
+    const uint32_t n = spec.num_ases, scale = spec.asn_scale;
+    for (uint32_t a = 1; a <= n; ++a) g.addNode(a * scale);
+    for (uint32_t a = 2; a <= n; ++a) {
+        uint32_t limit = a < spec.flat_below ? a - 1 : spec.flat_below + a / spec.spread_divisor;
+        uint32_t providers = 1 + rng.next() % spec.max_providers;
+        for (uint32_t k = 0; k < providers; ++k) {
+            g.addProvider(scale * (1 + rng.next() % std::min(limit, a - 1)), a * scale);
+        }
+    }
+    for (uint32_t k = 0; k < spec.peer_links; ++k) {
+        uint32_t a = 1 + rng.next() % n, b = 1 + rng.next() % n;
+        if (a != b) g.addPeer(a * scale, b * scale);
+    }
+}
+
+// Whole file contents (binary)
+inline std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
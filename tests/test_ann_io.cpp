@@ -2,9 +2,11 @@
 #include <fstream>
 #include <string>
 #include <cstdlib>
+#include <vector>
 
 #include "../include/ASGraph.h"
 #include "../include/Announcement.h"
+#include "../include/AnnouncementParser.h"
 
 static void fail(const std::string &msg) {
     std::cerr << "FAILED: " << msg << std::endl;
@@ -29,22 +31,48 @@ int main() {
     g.loadAnnouncementsFromFile(fn);
 
     // Check AS1 stored its prefix (non-ROV invalid)
-    if (g.get(1u)->policy->getLocalRIB().find("10.0.0.0/24") == g.get(1u)->policy->getLocalRIB().end()) {
+    if (!g.getRoute(1u, g.prefixId("10.0.0.0/24"))) {
         fail("AS1 should have seeded 10.0.0.0/24");
     }
 
     // Check AS2 stored its prefix and the ann has rov_invalid=true preserved in the stored announcement
-    auto it2 = g.get(2u)->policy->getLocalRIB().find("192.0.2.0/24");
-    if (it2 == g.get(2u)->policy->getLocalRIB().end()) {
+    auto r2 = g.getRoute(2u, g.prefixId("192.0.2.0/24"));
+    if (!r2) {
         fail("AS2 should have seeded 192.0.2.0/24");
     }
-    if (!it2->second.rov_invalid) {
+    if (r2 && !r2->rov_invalid) {
         fail("AS2's stored announcement should have rov_invalid=true");
     }
 
     // Cleanup
     std::remove(fn.c_str());
 
+    // Chunked parallel parsing yields the rows in file order
+    {
+        std::string text;
+        for (int i = 0; i < 300; ++i) {
+            text += std::to_string(i + 1) + ",10." + std::to_string(i % 250) + ".0.0/16," + (i % 2 ? "True" : "False") + "\n";
+            if (i % 50 == 0) text += "oops\n";
+        }
+        std::vector<AnnouncementRow> serial, chunked;
+        ParseReport serial_report, chunked_report;
+        parseAnnouncements(text.data(), text.data() + text.size(), serial, serial_report, 2);
+        parseChunked(text.data(), text.data() + text.size(), parseAnnouncements, chunked, chunked_report, 2, 4, 32);
+
+        bool same = serial.size() == chunked.size() && serial.size() == 300;
+        for (size_t i = 0; same && i < serial.size(); ++i) {
+            same = serial[i].seed_asn == chunked[i].seed_asn && serial[i].prefix == chunked[i].prefix &&
+                   serial[i].rov_invalid == chunked[i].rov_invalid;
+        }
+        if (!same) fail("Chunked announcement parse should match the serial parse row for row");
+        if (chunked_report.malformed_lines != serial_report.malformed_lines) {
+            fail("Chunked announcement parse should report the same malformed lines");
+        }
+        if (serial_report.malformed_lines.empty() || serial_report.malformed_lines[0] != 3) {
+            fail("First malformed announcement row should be reported on line 3");
+        }
+    }
+
     std::cout << "Announcement CSV IO test passed." << std::endl;
     return 0;
 }
@@ -5,6 +5,7 @@
 #include <vector>
 #include <algorithm>
 #include <cstdlib>
+#include <stdexcept>
 
 #include "../include/ASGraph.h"
 #include "../include/Announcement.h"
@@ -32,16 +33,20 @@ int main() {
     auto n1 = g.get(1u);
     auto n2 = g.get(2u);
     check(n1 != nullptr && n2 != nullptr, "Nodes 1 and 2 should exist after addProvider");
-    if (n1) check(!n1->_customers.empty() && n1->_customers[0] == 2u, "Node 1 should have customer 2");
-    if (n2) check(!n2->_providers.empty() && n2->_providers[0] == 1u, "Node 2 should have provider 1");
+    auto c1 = g.customersOf(1u);
+    auto p2 = g.providersOf(2u);
+    check(!c1.empty() && c1[0] == 2u, "Node 1 should have customer 2");
+    check(!p2.empty() && p2[0] == 1u, "Node 2 should have provider 1");
 
     // Test peer relationship
     g.addPeer(3u, 4u);
     auto n3 = g.get(3u);
     auto n4 = g.get(4u);
     check(n3 != nullptr && n4 != nullptr, "Nodes 3 and 4 should exist after addPeer");
-    if (n3) check(!n3->_peers.empty() && n3->_peers[0] == 4u, "Node 3 should peer with 4");
-    if (n4) check(!n4->_peers.empty() && n4->_peers[0] == 3u, "Node 4 should peer with 3");
+    auto peers3 = g.peersOf(3u);
+    auto peers4 = g.peersOf(4u);
+    check(!peers3.empty() && peers3[0] == 4u, "Node 3 should peer with 4");
+    check(!peers4.empty() && peers4[0] == 3u, "Node 4 should peer with 3");
 
     // Test buildGraphFromFile
     ASGraph g2;
@@ -54,21 +59,25 @@ int main() {
     auto n8 = g2.get(8u);
 
     check(n5 != nullptr && n6 != nullptr, "Nodes 5 and 6 should be created from file");
-    if (n5) check(!n5->_customers.empty() && n5->_customers[0] == 6u, "Node 5 should have customer 6 from file");
-    if (n6) check(!n6->_providers.empty() && n6->_providers[0] == 5u, "Node 6 should have provider 5 from file");
+    auto c5 = g2.customersOf(5u);
+    auto p6 = g2.providersOf(6u);
+    check(!c5.empty() && c5[0] == 6u, "Node 5 should have customer 6 from file");
+    check(!p6.empty() && p6[0] == 5u, "Node 6 should have provider 5 from file");
 
     check(n7 != nullptr && n8 != nullptr, "Nodes 7 and 8 should be created from file");
-    if (n7) check(!n7->_peers.empty() && n7->_peers[0] == 8u, "Node 7 should peer with 8 from file");
-    if (n8) check(!n8->_peers.empty() && n8->_peers[0] == 7u, "Node 8 should peer with 7 from file");
+    auto peers7 = g2.peersOf(7u);
+    auto peers8 = g2.peersOf(8u);
+    check(!peers7.empty() && peers7[0] == 8u, "Node 7 should peer with 8 from file");
+    check(!peers8.empty() && peers8[0] == 7u, "Node 8 should peer with 7 from file");
 
     // Ensure sample file graph has no provider cycles
     check(!g2.hasProviderCycle(), "Sample-edge graph should not contain provider cycles");
 
     // Test seeding an announcement into an AS local RIB
-    Announcement ann("1.2.0.0/16", 1u);
+    Announcement ann(g.internPrefix("1.2.0.0/16"), 1u);
     g.seedAnnouncement(1u, ann);
-    auto &rib = g.get(1u)->policy->getLocalRIB();
-    check(rib.find("1.2.0.0/16") != rib.end(), "Seeded announcement should appear in AS 1 local RIB");
+    auto rib = g.getRoute(1u, g.prefixId("1.2.0.0/16"));
+    check(rib.has_value(), "Seeded announcement should appear in AS 1 local RIB");
 
     // Propagation test: small provider chain 1->2->3 and peer 2<->4
     ASGraph gprop;
@@ -77,14 +86,14 @@ int main() {
     gprop.addPeer(2u, 4u);     // 2 peers with 4
 
     // Seed origin at AS 3
-    Announcement pann("5.5.0.0/16", 3u);
+    Announcement pann(gprop.internPrefix("5.5.0.0/16"), 3u);
     gprop.seedAnnouncement(3u, pann);
 
     // Confirm AS3 has the origin stored
-    auto &r3 = gprop.get(3u)->policy->getLocalRIB();
-    check(r3.find("5.5.0.0/16") != r3.end(), "AS3 should have the seeded announcement");
-    if (r3.find("5.5.0.0/16") != r3.end()) {
-        check(r3.at("5.5.0.0/16").as_path.size() == 1 && r3.at("5.5.0.0/16").as_path[0] == 3u,
+    auto r3 = gprop.getRoute(3u, gprop.prefixId("5.5.0.0/16"));
+    check(r3.has_value(), "AS3 should have the seeded announcement");
+    if (r3.has_value()) {
+        check(r3->as_path.size() == 1 && r3->as_path[0] == 3u,
               "AS3 stored path should be [3]");
     }
 
@@ -92,29 +101,39 @@ int main() {
     gprop.propagateAnnouncements();
 
     // After propagation, AS2 should have path [2,3], AS1 should have [1,2,3]
-    auto &r2 = gprop.get(2u)->policy->getLocalRIB();
-    auto &r1 = gprop.get(1u)->policy->getLocalRIB();
-    auto &r4 = gprop.get(4u)->policy->getLocalRIB();
+    auto r2 = gprop.getRoute(2u, gprop.prefixId("5.5.0.0/16"));
+    auto r1 = gprop.getRoute(1u, gprop.prefixId("5.5.0.0/16"));
+    auto r4 = gprop.getRoute(4u, gprop.prefixId("5.5.0.0/16"));
 
-    check(r2.find("5.5.0.0/16") != r2.end(), "AS2 should have received/stored the announcement");
-    if (r2.find("5.5.0.0/16") != r2.end()) {
-        check(r2.at("5.5.0.0/16").as_path.size() >= 2 && r2.at("5.5.0.0/16").as_path[0] == 2u,
+    check(r2.has_value(), "AS2 should have received/stored the announcement");
+    if (r2.has_value()) {
+        check(r2->as_path.size() >= 2 && r2->as_path[0] == 2u,
               "AS2 stored path should start with 2");
     }
 
-    check(r1.find("5.5.0.0/16") != r1.end(), "AS1 should have received/stored the announcement");
-    if (r1.find("5.5.0.0/16") != r1.end()) {
-        check(r1.at("5.5.0.0/16").as_path.size() >= 3 && r1.at("5.5.0.0/16").as_path[0] == 1u,
+    check(r1.has_value(), "AS1 should have received/stored the announcement");
+    if (r1.has_value()) {
+        check(r1->as_path.size() >= 3 && r1->as_path[0] == 1u,
               "AS1 stored path should start with 1");
     }
 
     // AS4 is a peer of AS2 and should have received the announcement across with path starting with 4
-    check(r4.find("5.5.0.0/16") != r4.end(), "AS4 (peer of AS2) should have received the announcement via peer step");
-    if (r4.find("5.5.0.0/16") != r4.end()) {
-        check(r4.at("5.5.0.0/16").as_path.size() >= 2 && r4.at("5.5.0.0/16").as_path[0] == 4u,
+    check(r4.has_value(), "AS4 (peer of AS2) should have received the announcement via peer step");
+    if (r4.has_value()) {
+        check(r4->as_path.size() >= 2 && r4->as_path[0] == 4u,
               "AS4 stored path should start with 4");
     }
 
+    // Duplicate edges are collapsed when the CSR arrays are built
+    ASGraph g_dup;
+    g_dup.addProvider(30u, 31u);
+    g_dup.addProvider(30u, 31u);
+    g_dup.addPeer(31u, 32u);
+    g_dup.addPeer(32u, 31u);
+    check(g_dup.customersOf(30u).size() == 1, "Duplicate provider edge should be stored once");
+    check(g_dup.providersOf(31u).size() == 1, "Duplicate customer edge should be stored once");
+    check(g_dup.peersOf(31u).size() == 1 && g_dup.peersOf(32u).size() == 1, "Duplicate peer edge should be stored once");
+
     // Create an explicit no-cycle chain and check false
     ASGraph g_no_cycle;
     g_no_cycle.addProvider(20u, 21u);
@@ -128,6 +147,36 @@ int main() {
     g_cycle.addProvider(12u, 10u);
     check(g_cycle.hasProviderCycle(), "Provider cycle should be detected (10->11->12->10)");
 
+    // The reported component is the cycle itself, not the ASes hanging off it
+    g_cycle.addProvider(13u, 10u); // provider above the cycle
+    g_cycle.addProvider(12u, 14u); // customer below the cycle
+    check(g_cycle.providerCycle() == std::vector<uint32_t>({10u, 11u, 12u}),
+          "Provider cycle component should be exactly ASes 10, 11 and 12");
+    bool threw = false;
+    try {
+        g_cycle.flattenByProviders();
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    check(threw, "flattenByProviders should throw on a provider cycle");
+
+    // An AS that is its own provider is a cycle too
+    ASGraph g_self;
+    g_self.addProvider(40u, 40u);
+    check(g_self.providerCycle() == std::vector<uint32_t>({40u}), "Self provider edge should be reported as a cycle");
+
+    // Deep provider chains are ranked without recursion; the cached ranks are
+    // recomputed once the topology changes
+    ASGraph g_deep;
+    const uint32_t depth = 200000;
+    for (uint32_t a = 1; a < depth; ++a) g_deep.addProvider(a + 1, a);
+    auto deep_ranks = g_deep.flattenByProviders();
+    check(deep_ranks.size() == depth, "Chain of 200000 ASes should have 200000 ranks");
+    check(g_deep.get(depth)->_propagation_rank == (int)depth - 1, "Top of the chain should have the highest rank");
+    g_deep.addProvider(1u, depth); // closes the chain into a cycle
+    check(g_deep.hasProviderCycle(), "Closing the chain should invalidate the cached ranks and report a cycle");
+    check(g_deep.providerCycle().size() == depth, "Whole chain should be reported as the cycle component");
+
     if (errors == 0) {
         std::cout << "All tests passed." << std::endl;
         return 0;
@@ -0,0 +1,186 @@
+// g++ -std=c++17 -pthread -I include $(ls src/*.cpp | grep -v main.cpp) tests/test_incremental.cpp -o tests/run_incremental -lz -lbz2
+
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../include/ASGraph.h"
+#include "TestHelpers.h"
+
+struct Seed {
+    uint32_t asn;
+    uint32_t prefix;
+    bool rov_invalid;
+};
+
+// Random provider hierarchy with sparse peering; deterministic for a given seed
+static void buildTopology(ASGraph& g, uint32_t seed, uint32_t num_ases) {
+    TestRng rng(seed);
+    buildHierarchy(g, rng, {num_ases, 30, 8, 3, num_ases / 2});
+    for (uint32_t p = 0; p < 6; ++p) g.internPrefix("10." + std::to_string(p) + ".0.0/16");
+}
+
+static Announcement makeAnnouncement(const Seed& s) {
+    Announcement ann(s.prefix, s.asn);
+    ann.rov_invalid = s.rov_invalid;
+    return ann;
+}
+
+// Full propagation of `seeds` with ROV at `rov`
+static void buildReference(ASGraph& g, uint32_t seed, uint32_t num_ases, const std::vector<Seed>& seeds,
+                           const std::set<uint32_t>& rov) {
+    buildTopology(g, seed, num_ases);
+    for (uint32_t asn : rov) g.setROV(asn);
+    for (const Seed& s : seeds) g.seedAnnouncement(s.asn, makeAnnouncement(s));
+    g.propagateAnnouncements();
+}
+
+static bool sameRIBs(const ASGraph& a, const ASGraph& b) {
+    for (uint32_t p = 0; p < a.prefixes().size(); ++p) {
+        for (uint32_t asn = 1; asn <= a.size(); ++asn) {
+            auto x = a.getRoute(asn, p);
+            auto y = b.getRoute(asn, p);
+            if (x.has_value() != y.has_value()) return false;
+            if (x && (x->as_path != y->as_path || x->next_hop_asn != y->next_hop_asn ||
+                      x->received_from != y->received_from || x->rov_invalid != y->rov_invalid)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    int errors = 0;
+    auto check = [&](bool cond, const std::string& msg) {
+        if (!cond) {
+            std::cerr << "FAILED: " << msg << std::endl;
+            ++errors;
+        }
+    };
+
+    const uint32_t topo = 5, num_ases = 1500;
+    std::vector<Seed> seeds = {{700, 0, false}, {1200, 0, true}, {40, 1, false}, {900, 2, false},
+                               {901, 2, true},  {1499, 3, false}, {3, 4, false}, {1000, 5, false}};
+    std::set<uint32_t> rov;
+    for (uint32_t a = 1; a <= num_ases; a += 9) rov.insert(a);
+
+    ASGraph g;
+    buildTopology(g, topo, num_ases);
+    for (uint32_t asn : rov) g.setROV(asn);
+    for (const Seed& s : seeds) g.seedAnnouncement(s.asn, makeAnnouncement(s));
+    g.propagateAnnouncements();
+
+    // Test 1: each update leaves the same RIBs as propagating from scratch
+    {
+        auto compare = [&](const std::string& what) {
+            ASGraph ref;
+            buildReference(ref, topo, num_ases, seeds, rov);
+            check(sameRIBs(g, ref), what + " should match a full propagation");
+        };
+
+        Seed hijack{350, 0, true};
+        g.announce(hijack.asn, makeAnnouncement(hijack));
+        seeds.push_back(hijack);
+        compare("Announcing a hijack");
+
+        check(g.withdraw(700, 0) > 0, "Withdrawing an existing seed should re-evaluate its AS");
+        seeds.erase(seeds.begin());
+        compare("Withdrawing the legitimate origin");
+
+        for (uint32_t asn : {2u, 17u, 350u, 1200u, 44u}) {
+            g.updateROV(asn, true);
+            rov.insert(asn);
+        }
+        compare("Deploying ROV");
+
+        for (uint32_t asn : {10u, 1u, 901u}) {
+            g.updateROV(asn, false);
+            rov.erase(asn);
+        }
+        compare("Dropping ROV");
+
+        Seed moved{1100, 3, false};
+        g.withdraw(1499, 3);
+        g.announce(moved.asn, makeAnnouncement(moved));
+        seeds.erase(std::find_if(seeds.begin(), seeds.end(), [](const Seed& s) { return s.asn == 1499; }));
+        seeds.push_back(moved);
+        compare("Moving an origin");
+    }
+
+    // Test 2: updates only visit what they can affect
+    {
+        check(g.withdraw(12, 4) == 0, "Withdrawing a seed that does not exist should do nothing");
+
+        // ROV only changes routes of prefixes with invalid seeds
+        std::vector<Seed> valid = {{5, 0, false}, {6, 1, false}};
+        ASGraph h;
+        buildReference(h, topo, 200, valid, {});
+        check(h.updateROV(77, true) == 0, "ROV on a graph without invalid routes should touch no prefix");
+
+        // A seed that loses to the AS's current route only reaches its neighbors
+        Announcement longer(h.prefixId("10.0.0.0/16"), 5);
+        longer.as_path = {5, 9, 9, 9};
+        size_t degree = h.providersOf(5).size() + h.customersOf(5).size() + h.peersOf(5).size();
+        size_t evaluated = h.announce(5, longer);
+        check(evaluated >= 1 && evaluated <= 1 + degree, "A losing seed should stop at the neighbors of its AS");
+    }
+
+    // Test 3: before propagation the updates only edit the seeds
+    {
+        ASGraph h;
+        buildTopology(h, topo, 50);
+        Announcement bad(0, 20);
+        bad.rov_invalid = true;
+        h.announce(20, bad);
+        check(h.getRoute(20, 0).has_value(), "An announced seed should be in the RIB");
+        h.updateROV(20, true);
+        check(!h.getRoute(20, 0).has_value(), "ROV should drop the invalid seed");
+        h.updateROV(20, false);
+        check(h.getRoute(20, 0).has_value(), "Dropping ROV should restore it");
+        h.withdraw(20, 0);
+        check(!h.getRoute(20, 0).has_value(), "Withdrawing should remove it");
+        h.propagateAnnouncements();
+        check(!h.getRoute(1, 0).has_value(), "Nothing should propagate once the seed is gone");
+    }
+
+    // Test 4: identically seeded prefixes share one propagation, and updates
+    // to any of them leave the same RIBs as keeping them apart
+    {
+        ASGraph shared, apart;
+        apart.setSharePrefixes(false);
+        std::vector<Seed> same = {{300, 0, false}, {800, 0, true}, {800, 2, true}, {300, 2, false},
+                                  {300, 4, false}, {800, 4, true},  {60, 1, false},  {60, 3, false},
+                                  {61, 5, false}};
+        for (ASGraph *h : {&shared, &apart}) {
+            buildTopology(*h, topo, 900);
+            for (uint32_t a = 1; a <= 900; a += 4) h->setROV(a);
+            for (const Seed& s : same) h->seedAnnouncement(s.asn, makeAnnouncement(s));
+            h->propagateAnnouncements();
+        }
+        check(shared.propagationStats().prefixes == 3 && shared.propagationStats().shared == 3,
+              "Prefixes 2 and 4 should share 0's routes and 3 should share 1's");
+        check(apart.propagationStats().prefixes == 6, "Without sharing every prefix propagates");
+        check(sameRIBs(shared, apart), "Shared prefixes should read the same routes");
+
+        Seed extra{450, 2, false};
+        for (ASGraph *h : {&shared, &apart}) {
+            h->announce(extra.asn, makeAnnouncement(extra));
+            h->withdraw(300, 0);
+            h->updateROV(800, true);
+            h->updateROV(1, false);
+            h->withdraw(60, 3);
+        }
+        check(sameRIBs(shared, apart), "Updates to shared prefixes should match keeping them apart");
+    }
+
+    if (errors == 0) {
+        std::cout << "Incremental update tests passed." << std::endl;
+        return 0;
+    } else {
+        std::cerr << errors << " incremental test(s) failed." << std::endl;
+        return 1;
+    }
+}
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <sstream>
+#include <cstdio>
 
 #include "../include/ASGraph.h"
 #include "../include/Announcement.h"
@@ -18,7 +19,7 @@ int main() {
     // Test 1: Single AS with one origin announcement
     {
         ASGraph g1;
-        Announcement a1("10.0.0.0/24", 1u);
+        Announcement a1(g1.internPrefix("10.0.0.0/24"), 1u);
         g1.seedAnnouncement(1u, a1);
         g1.propagateAnnouncements();
         const std::string out1 = "tests/out1.csv";
@@ -55,7 +56,7 @@ int main() {
         g2.addProvider(1u, 2u); // 1 provider of 2
         g2.addProvider(2u, 3u); // 2 provider of 3
 
-        Announcement a2("192.0.2.0/24", 3u);
+        Announcement a2(g2.internPrefix("192.0.2.0/24"), 3u);
         g2.seedAnnouncement(3u, a2);
         g2.propagateAnnouncements();
         const std::string out2 = "tests/out2.csv";
@@ -103,8 +104,8 @@ int main() {
         g3.addProvider(4u, 666u);
 
         // Make the announcement seeded at AS3 have a longer AS-path so AS4 prefers ASN 666's shorter path
-        Announcement long_ann("9.9.0.0/16", 9u, Relationship::Customer, std::vector<uint32_t>{9u,8u,3u});
-        Announcement short_ann("9.9.0.0/16", 666u);
+        Announcement long_ann(g3.internPrefix("9.9.0.0/16"), 9u, Relationship::Customer, std::vector<uint32_t>{9u,8u,3u});
+        Announcement short_ann(g3.internPrefix("9.9.0.0/16"), 666u);
 
         g3.seedAnnouncement(3u, long_ann);
         g3.seedAnnouncement(666u, short_ann);
@@ -153,6 +154,80 @@ int main() {
         if (!found4) fail("ASN 4 row missing from out3.csv");
     }
 
+    // Test 4: threaded formatting writes the same file, and sorted prefixes
+    // reorder each AS's rows without changing them
+    {
+        ASGraph g4;
+        const uint32_t num_ases = 1000;
+        for (uint32_t a = 2; a <= num_ases; ++a) {
+            g4.addProvider(a / 2, a);
+            if (a % 7 == 0) g4.addPeer(a, a - 3);
+        }
+        const std::vector<std::string> texts = {"10.2.0.0/16", "2001:db8::/32", "10.1.0.0/24", "10.1.0.0/16",
+                                                "9.0.0.0/8"};
+        for (uint32_t p = 0; p < texts.size(); ++p) {
+            g4.seedAnnouncement(100 + 200 * p, Announcement(g4.internPrefix(texts[p]), 100 + 200 * p));
+        }
+        g4.propagateAnnouncements();
+
+        auto readAll = [](const std::string &fn) {
+            std::ifstream in(fn, std::ios::binary);
+            std::ostringstream ss;
+            ss << in.rdbuf();
+            return ss.str();
+        };
+        const std::string serial_fn = "tests/tmp_out4.csv", threaded_fn = "tests/tmp_out4_threads.csv",
+                          sorted_fn = "tests/tmp_out4_sorted.csv";
+        g4.dumpRIBsToCSV(serial_fn);
+        RIBDumpOptions options;
+        options.threads = 3;
+        g4.dumpRIBsToCSV(threaded_fn, options);
+        options.sort_prefixes = true;
+        g4.dumpRIBsToCSV(sorted_fn, options);
+        const std::string serial = readAll(serial_fn), threaded = readAll(threaded_fn), sorted = readAll(sorted_fn);
+        std::remove(serial_fn.c_str());
+        std::remove(threaded_fn.c_str());
+        std::remove(sorted_fn.c_str());
+
+        if (serial != threaded) fail("Threaded dump should match the serial dump byte for byte");
+        std::istringstream in(serial);
+        std::string line, expected = "asn,prefix,as_path\n";
+        std::getline(in, line);
+        for (uint32_t asn = 1; asn <= num_ases; ++asn) {
+            for (uint32_t p = 0; p < texts.size(); ++p) {
+                auto route = g4.getRoute(asn, p);
+                if (!route) continue;
+                std::ostringstream row;
+                row << asn << ',' << texts[p] << ",\"(";
+                for (size_t i = 0; i < route->as_path.size(); ++i) row << (i ? ", " : "") << route->as_path[i];
+                row << (route->as_path.size() == 1 ? ",)\"\n" : ")\"\n");
+                expected += row.str();
+            }
+        }
+        if (serial != expected) fail("Dump should list every route by ASN, then prefix ID");
+
+        std::vector<std::string> a, b;
+        std::istringstream sa(serial), sb(sorted);
+        while (std::getline(sa, line)) a.push_back(line);
+        while (std::getline(sb, line)) b.push_back(line);
+        if (a.size() != b.size() || !std::is_permutation(a.begin(), a.end(), b.begin())) {
+            fail("Sorted dump should hold the same rows");
+        }
+        const std::vector<std::string> order = {"9.0.0.0/8", "10.1.0.0/16", "10.1.0.0/24", "10.2.0.0/16",
+                                                "2001:db8::/32"};
+        for (size_t i = 1; i < b.size(); ++i) {
+            auto asnOf = [](const std::string &l) { return std::stoul(l.substr(0, l.find(','))); };
+            auto rankOf = [&](const std::string &l) {
+                auto p1 = l.find(',');
+                std::string prefix = l.substr(p1 + 1, l.find(',', p1 + 1) - p1 - 1);
+                return std::find(order.begin(), order.end(), prefix) - order.begin();
+            };
+            if (i > 1 && asnOf(b[i - 1]) == asnOf(b[i]) && rankOf(b[i - 1]) >= rankOf(b[i])) {
+                fail("Sorted dump should order each AS's rows by prefix, got " + b[i - 1] + " before " + b[i]);
+            }
+        }
+    }
+
     std::cout << "Output CSV tests passed." << std::endl;
     return 0;
 }
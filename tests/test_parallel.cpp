@@ -0,0 +1,159 @@
+// g++ -std=c++17 -pthread -I include $(ls src/*.cpp | grep -v main.cpp) tests/test_parallel.cpp -o tests/run_parallel -lz -lbz2
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/ASGraph.h"
+#include "../include/WorkStealingPool.h"
+#include "TestHelpers.h"
+
+// Provider hierarchy with a wide bottom rank, sparse peering, a few seeds per
+// prefix (some ROV invalid) and some ROV ASes; deterministic for a given seed
+static void buildScenario(ASGraph& g, uint32_t seed) {
+    TestRng rng(seed);
+    const uint32_t num_ases = 3000;
+    buildHierarchy(g, rng, {num_ases, 50, 10, 3, 2000});
+    for (uint32_t a = 1; a <= num_ases; a += 7) g.setROV(a);
+
+    for (uint32_t p = 0; p < 12; ++p) {
+        uint32_t prefix = g.internPrefix("10." + std::to_string(p) + ".0.0/16");
+        for (uint32_t k = 0; k < 1 + p % 3; ++k) {
+            uint32_t origin = 1 + rng.next() % num_ases;
+            Announcement ann(prefix, origin);
+            ann.rov_invalid = k > 0;
+            g.seedAnnouncement(origin, ann);
+        }
+    }
+}
+
+int main() {
+    int errors = 0;
+    auto check = [&](bool cond, const std::string& msg) {
+        if (!cond) {
+            std::cerr << "FAILED: " << msg << std::endl;
+            ++errors;
+        }
+    };
+
+    // Test 1: parallelFor runs every index exactly once, also when the work
+    // per chunk is very uneven
+    {
+        WorkStealingPool pool(4);
+        check(pool.size() == 4, "The pool should report its worker count");
+        for (size_t n : {0u, 1u, 100u, 10007u}) {
+            std::vector<std::atomic<int>> hits(n);
+            std::atomic<uint64_t> spin{0};
+            std::atomic<bool> bad_worker{false};
+            pool.parallelFor(n, 64, [&](size_t b, size_t e, unsigned worker) {
+                if (worker >= pool.size()) bad_worker = true;
+                for (size_t i = b; i < e; ++i) {
+                    ++hits[i];
+                    // The first chunks are much more expensive than the rest
+                    if (i < 256) for (int k = 0; k < 20000; ++k) spin += k & 1;
+                }
+            });
+            bool once = !bad_worker;
+            for (auto& h : hits) once = once && h == 1;
+            check(once, "Every index should be visited once for n = " + std::to_string(n));
+        }
+    }
+
+    // Test 2: rank-parallel propagation matches the serial run exactly
+    {
+        ASGraph serial, parallel;
+        buildScenario(serial, 7);
+        buildScenario(parallel, 7);
+        parallel.setThreads(4);
+        serial.propagateAnnouncements();
+        parallel.propagateAnnouncements();
+
+        bool same = true;
+        size_t routes = 0;
+        for (uint32_t p = 0; p < serial.prefixes().size(); ++p) {
+            for (uint32_t a = 1; a <= serial.size(); ++a) {
+                auto s = serial.getRoute(a, p);
+                auto q = parallel.getRoute(a, p);
+                routes += s.has_value();
+                same = same && s.has_value() == q.has_value();
+                if (s && q) {
+                    same = same && s->as_path == q->as_path && s->next_hop_asn == q->next_hop_asn &&
+                           s->received_from == q->received_from && s->rov_invalid == q->rov_invalid;
+                }
+            }
+        }
+        check(routes > 10000, "The scenario should propagate widely");
+        check(same, "Parallel propagation should select the same routes as the serial run");
+        check(serial.propagationStats().offers == parallel.propagationStats().offers,
+              "Both runs should make the same number of offers");
+    }
+
+    // Test 3: prefix shards match the serial run too
+    {
+        ASGraph serial, sharded;
+        buildScenario(serial, 11);
+        buildScenario(sharded, 11);
+        sharded.setPrefixShards(5);
+        serial.propagateAnnouncements();
+        sharded.propagateAnnouncements();
+
+        bool same = true;
+        for (uint32_t p = 0; p < serial.prefixes().size(); ++p) {
+            for (uint32_t a = 1; a <= serial.size(); ++a) {
+                auto s = serial.getRoute(a, p);
+                auto q = sharded.getRoute(a, p);
+                same = same && s.has_value() == q.has_value();
+                if (s && q) same = same && s->as_path == q->as_path && s->rov_invalid == q->rov_invalid;
+            }
+        }
+        const PropagationStats &st = sharded.propagationStats();
+        check(same, "Sharded propagation should select the same routes as the serial run");
+        check(st.shards == 5 && st.prefixes == 12, "All prefixes should be spread over the shards");
+        check(st.offers == serial.propagationStats().offers && st.steps == serial.propagationStats().steps,
+              "Shard counters should add up to the serial run's");
+    }
+
+    // Test 4: the serial engine only sends from ASes that hold a route
+    {
+        ASGraph g;
+        buildScenario(g, 13);
+        g.propagateAnnouncements();
+        const PropagationStats &st = g.propagationStats();
+
+        // Every AS above rank 0 that ends up with a route sends once going down
+        uint64_t holders_above_leaves = 0;
+        for (uint32_t p = 0; p < g.prefixes().size(); ++p) {
+            for (uint32_t a = 1; a <= g.size(); ++a) {
+                holders_above_leaves += g.getRoute(a, p).has_value() && g.get(a)->_propagation_rank > 0;
+            }
+        }
+        check(st.scanned == st.prefixes * g.size(), "A full scan would visit every AS per prefix");
+        check(st.sent_down == holders_above_leaves, "Down senders should be the route holders above rank 0");
+        check(st.sent_up <= st.sent_across && st.sent_across < st.scanned, "Fewer ASes should send than exist");
+
+        // An invalid route that every neighbor drops never leaves its origin
+        ASGraph h;
+        for (uint32_t a = 1; a <= 4; ++a) h.addNode(a);
+        h.addProvider(1, 2);
+        h.addProvider(3, 2);
+        h.addPeer(2, 4);
+        for (uint32_t a : {1u, 3u, 4u}) h.setROV(a);
+        Announcement bad(h.internPrefix("10.9.0.0/16"), 2);
+        bad.rov_invalid = true;
+        h.seedAnnouncement(2, bad);
+        h.propagateAnnouncements();
+        const PropagationStats &hs = h.propagationStats();
+        check(hs.sent_up == 1 && hs.sent_across == 1 && hs.sent_down == 0 && hs.offers == 0,
+              "Only the origin should send, and nobody should accept");
+    }
+
+    if (errors == 0) {
+        std::cout << "Parallel propagation tests passed." << std::endl;
+        return 0;
+    } else {
+        std::cerr << errors << " parallel test(s) failed." << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,200 @@
+// g++ -std=c++17 -pthread -I include $(ls src/*.cpp | grep -v main.cpp) tests/test_parser.cpp -o tests/run_parser -lz -lbz2
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include <bzlib.h>
+#include <zlib.h>
+
+#include "../include/ASGraph.h"
+#include "../include/Decompressor.h"
+#include "../include/MappedFile.h"
+#include "../include/PrefixTable.h"
+#include "../include/RelationshipParser.h"
+
+int main() {
+    int errors = 0;
+    auto check = [&](bool cond, const std::string& msg) {
+        if (!cond) {
+            std::cerr << "FAILED: " << msg << std::endl;
+            ++errors;
+        }
+    };
+
+    // Test 1: serial-1 and serial-2 rows, comments, CRLF and malformed rows
+    {
+        const std::string text =
+            "# source:topology|BGP\n"     // line 1
+            "1|2|-1\n"                    // line 2
+            "3|4|0|bgp\r\n"               // line 3 (serial-2 source column, CRLF)
+            "\n"                          // line 4
+            " 5 | 6 | -1 \n"              // line 5 (padded fields)
+            "7|x|0\n"                     // line 6 malformed ASN
+            "8|9\n"                       // line 7 missing relationship
+            "99999999999|1|0\n"           // line 8 ASN out of range
+            "10|11|0";                    // line 9 (no trailing newline)
+
+        std::vector<ASRelationship> edges;
+        ParseReport report;
+        parseRelationships(text.data(), text.data() + text.size(), edges, report);
+
+        check(edges.size() == 4, "Expected 4 well-formed edges, got " + std::to_string(edges.size()));
+        if (edges.size() == 4) {
+            check(edges[0].asn1 == 1u && edges[0].asn2 == 2u && edges[0].rel == -1, "Edge 1|2|-1 parsed incorrectly");
+            check(edges[1].asn1 == 3u && edges[1].asn2 == 4u && edges[1].rel == 0, "Edge 3|4|0|bgp parsed incorrectly");
+            check(edges[2].asn1 == 5u && edges[2].asn2 == 6u && edges[2].rel == -1, "Padded edge 5|6|-1 parsed incorrectly");
+            check(edges[3].asn1 == 10u && edges[3].asn2 == 11u && edges[3].rel == 0, "Final edge without newline parsed incorrectly");
+        }
+
+        check(report.lines == 9, "Expected 9 lines scanned, got " + std::to_string(report.lines));
+        check(report.malformed_lines == std::vector<size_t>({6, 7, 8}),
+              "Malformed rows should be reported on lines 6, 7 and 8");
+    }
+
+    // Test 2: numbering continues from `first_line`
+    {
+        const std::string text = "1|2|-1\nbad\n";
+        std::vector<ASRelationship> edges;
+        ParseReport report;
+        parseRelationships(text.data(), text.data() + text.size(), edges, report, 100);
+        check(report.malformed_lines == std::vector<size_t>({101}), "Malformed row should be reported on line 101");
+    }
+
+    // Test 3: chunked parallel parsing matches a serial parse, including line numbers
+    {
+        std::string text = "# header\n";
+        for (int i = 0; i < 500; ++i) {
+            text += std::to_string(i) + "|" + std::to_string(i + 1) + (i % 3 ? "|-1\n" : "|0|bgp\n");
+            if (i % 97 == 0) text += "broken|row\n";
+        }
+
+        std::vector<ASRelationship> serial, chunked;
+        ParseReport serial_report, chunked_report;
+        parseRelationships(text.data(), text.data() + text.size(), serial, serial_report);
+        parseChunked(text.data(), text.data() + text.size(), parseRelationships, chunked, chunked_report, 1, 4, 64);
+
+        bool same = serial.size() == chunked.size();
+        for (size_t i = 0; same && i < serial.size(); ++i) {
+            same = serial[i].asn1 == chunked[i].asn1 && serial[i].asn2 == chunked[i].asn2 && serial[i].rel == chunked[i].rel;
+        }
+        check(same, "Chunked parse should produce the same edges in the same order as a serial parse");
+        check(chunked_report.malformed_lines == serial_report.malformed_lines,
+              "Chunked parse should report the same malformed line numbers");
+        check(chunked_report.lines == serial_report.lines, "Chunked parse should count the same number of lines");
+
+        auto chunks = splitAtLines(text.data(), text.data() + text.size(), 4);
+        check(chunks.size() == 4, "Input should be split into 4 chunks");
+        for (size_t c = 0; c + 1 < chunks.size(); ++c) {
+            check(chunks[c].second[-1] == '\n', "Chunks should end on a line boundary");
+        }
+    }
+
+    // Test 4: mapped file loader produces the same graph and survives malformed rows
+    {
+        const std::string fn = "tests/tmp_rel.txt";
+        {
+            std::ofstream out(fn);
+            out << "# header\n1|2|-1|bgp\n2|3|0|mlp\nnot|a|row\n1|3|-1\n";
+        }
+
+        MappedFile file;
+        check(file.open(fn), "MappedFile should open the temporary relationships file");
+        check(file.size() > 0, "Mapped file should not be empty");
+
+        ASGraph g;
+        g.buildGraphFromFile(fn);
+        check(g.customersOf(1u).size() == 2, "AS1 should have two customers after parsing");
+        auto peers2 = g.peersOf(2u);
+        check(peers2.size() == 1 && peers2[0] == 3u, "AS2 should peer with AS3");
+
+        std::remove(fn.c_str());
+    }
+
+    // Test 5: .gz and .bz2 inputs are decompressed in-process, in blocks of whole lines
+    {
+        std::string text = "# compressed\n";
+        for (int i = 1; i <= 200; ++i) text += std::to_string(i) + "|" + std::to_string(i + 1000) + "|-1|bgp\n";
+        text += "7|8|0";  // no trailing newline
+
+        const std::string gz_fn = "tests/tmp_rel.txt.gz";
+        gzFile gz = gzopen(gz_fn.c_str(), "wb");
+        gzwrite(gz, text.data(), static_cast<unsigned>(text.size()));
+        gzclose(gz);
+
+        const std::string bz_fn = "tests/tmp_rel.txt.bz2";
+        std::vector<char> packed(text.size() * 2 + 600);
+        unsigned packed_len = static_cast<unsigned>(packed.size());
+        BZ2_bzBuffToBuffCompress(packed.data(), &packed_len, const_cast<char*>(text.data()),
+                                 static_cast<unsigned>(text.size()), 9, 0, 0);
+        {
+            std::ofstream out(bz_fn, std::ios::binary);
+            out.write(packed.data(), packed_len);
+        }
+
+        check(isCompressedPath(gz_fn) && isCompressedPath(bz_fn) && !isCompressedPath("tests/sample_edges.txt"),
+              "Compressed paths should be detected by extension");
+
+        for (const std::string &fn : {gz_fn, bz_fn}) {
+            // Tiny blocks force lines to be stitched across block boundaries
+            std::string seen;
+            bool whole_lines = true;
+            bool ok = readCompressedLines(fn, [&](const char* b, const char* e) {
+                seen.append(b, e);
+                if (seen.size() < text.size() && e[-1] != '\n') whole_lines = false;
+            }, 7);
+            check(ok, "Decompressing " + fn + " should succeed");
+            check(seen == text, "Decompressed bytes of " + fn + " should match the original");
+            check(whole_lines, "Only whole lines should be handed to the parser for " + fn);
+
+            ASGraph g;
+            check(g.buildGraphFromFile(fn), "buildGraphFromFile should accept " + fn);
+            check(g.customersOf(200u) == std::vector<uint32_t>{1200u}, "AS200 should have customer 1200 from " + fn);
+            check(g.peersOf(7u) == std::vector<uint32_t>{8u}, "AS7 should peer with AS8 from " + fn);
+            std::remove(fn.c_str());
+        }
+    }
+
+    // Test 6: missing files are reported, not thrown
+    {
+        MappedFile file;
+        check(!file.open("tests/does_not_exist.txt"), "Opening a missing file should fail");
+        ASGraph g;
+        check(!g.buildGraphFromFile("tests/does_not_exist.txt.gz"), "A missing compressed file should be reported");
+    }
+
+    // Test 7: prefix parsing and interning
+    {
+        Prefix p;
+        check(parsePrefix("10.1.0.0/16", p) && !p.ipv6 && p.length == 16 && p.addr[0] == 10 && p.addr[1] == 1,
+              "IPv4 prefix should parse");
+        check(parsePrefix("2001:db8::/32", p) && p.ipv6 && p.length == 32 && p.addr[0] == 0x20 && p.addr[3] == 0xb8,
+              "IPv6 prefix should parse");
+        check(parsePrefix("::ffff:1.2.3.4/128", p) && p.ipv6 && p.addr[10] == 0xff && p.addr[15] == 4,
+              "IPv6 prefix with an IPv4 tail should parse");
+        for (const char* bad : {"10.1.0.0", "10.1.0.0/33", "256.0.0.0/8", "1.2.3/24", "1::2::3/64", "2001:db8::/129", ""})
+            check(!parsePrefix(bad, p), std::string("Invalid prefix should be rejected: ") + bad);
+
+        PrefixTable table;
+        uint32_t a = table.intern("1.2.0.0/16");
+        uint32_t b = table.intern("2001:db8::/32");
+        check(a == 0 && b == 1, "Prefix IDs should be dense in first-seen order");
+        check(table.intern("1.2.0.0/16") == a, "Re-interning a prefix should return its existing ID");
+        check(table.intern("2001:0db8:0::/32") == b, "Equivalent IPv6 spellings should share an ID");
+        check(table.text(b) == "2001:db8::/32", "The first-seen text should be kept for output");
+        check(table.intern("not a prefix") == PrefixTable::kInvalid && table.size() == 2,
+              "Invalid prefixes should not be interned");
+        check(table.find("1.2.0.0/16") == a && table.find("3.0.0.0/8") == PrefixTable::kInvalid,
+              "find() should only return interned prefixes");
+    }
+
+    if (errors == 0) {
+        std::cout << "Relationship parser tests passed." << std::endl;
+        return 0;
+    } else {
+        std::cerr << errors << " parser test(s) failed." << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,152 @@
+// g++ -std=c++17 -pthread -I include $(ls src/*.cpp | grep -v main.cpp) tests/test_prefix_index.cpp -o tests/run_prefix_index -lz -lbz2
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/ASGraph.h"
+#include "../include/PrefixIndex.h"
+
+static std::string dotted(uint32_t a) {
+    return std::to_string(a >> 24) + "." + std::to_string((a >> 16) & 255) + "." + std::to_string((a >> 8) & 255) +
+           "." + std::to_string(a & 255);
+}
+
+static bool covers(const Prefix& p, const Prefix& address) {
+    if (p.ipv6 != address.ipv6) return false;
+    for (unsigned bit = 0; bit < p.length; ++bit) {
+        unsigned mask = 0x80u >> (bit % 8);
+        if ((p.addr[bit / 8] & mask) != (address.addr[bit / 8] & mask)) return false;
+    }
+    return true;
+}
+
+int main() {
+    int errors = 0;
+    auto check = [&](bool cond, const std::string& msg) {
+        if (!cond) {
+            std::cerr << "FAILED: " << msg << std::endl;
+            ++errors;
+        }
+    };
+
+    // Test 1: addresses parse as full-length prefixes
+    {
+        Prefix a, b;
+        check(parseAddress("1.2.3.4", a) && a.length == 32 && !a.ipv6 && a.addr[3] == 4, "IPv4 address");
+        check(parseAddress("2001:db8::1", b) && b.length == 128 && b.ipv6 && b.addr[15] == 1, "IPv6 address");
+        check(!parseAddress("1.2.3.0/24", a) && !parseAddress("1.2.3", a), "Prefixes and junk are not addresses");
+    }
+
+    // Test 2: lookups agree with a linear scan over random nested prefixes
+    {
+        uint32_t state = 17;
+        auto next = [&]() {
+            state = state * 1664525u + 1013904223u;
+            return state;
+        };
+        PrefixTable table;
+        for (int k = 0; k < 400; ++k) {
+            // Cluster the networks under a few /8s so that many of them nest
+            uint32_t addr = ((10u + next() % 4) << 24) | (next() >> 8);
+            unsigned len = 8 + next() % 25;
+            table.intern(dotted(addr) + "/" + std::to_string(len));
+        }
+        table.intern("0.0.0.0/0");
+        table.intern("10.1.0.0/16");
+        table.intern("10.1.0.7/16");  // same network as above, host bits set
+        table.intern("2001:db8::/32");
+        table.intern("2001:db8:1::/48");
+
+        PrefixIndex index;
+        index.build(table);
+
+        std::vector<Prefix> addresses;
+        for (int k = 0; k < 3000; ++k) {
+            Prefix a;
+            parseAddress(dotted(((10u + next() % 5) << 24) | (next() >> 8)), a);
+            addresses.push_back(a);
+        }
+        Prefix v6;
+        parseAddress("2001:db8:1::5", v6);
+        addresses.push_back(v6);
+        parseAddress("10.1.2.3", addresses[0]);
+
+        auto odd = [](uint32_t p) { return p % 2 == 1; };
+        std::vector<uint32_t> batch(addresses.size()), found;
+        index.longestMatches(addresses.data(), addresses.size(), batch.data(), odd);
+
+        bool same = true, sorted = true;
+        for (size_t k = 0; k < addresses.size(); ++k) {
+            std::vector<uint32_t> expected;
+            for (uint32_t p = 0; p < table.size(); ++p) {
+                if (covers(table.prefix(p), addresses[k])) expected.push_back(p);
+            }
+            index.matches(addresses[k], found);
+            std::vector<uint32_t> a = found, b = expected;
+            std::sort(a.begin(), a.end());
+            same = same && a == b;
+            for (size_t i = 1; i < found.size(); ++i) {
+                sorted = sorted && table.prefix(found[i - 1]).length >= table.prefix(found[i]).length;
+            }
+
+            uint32_t best = PrefixTable::kInvalid;
+            for (uint32_t p : expected) {
+                if (odd(p) && (best == PrefixTable::kInvalid || table.prefix(p).length > table.prefix(best).length))
+                    best = p;
+            }
+            same = same && batch[k] == best;
+        }
+        check(same, "Matches and longest matches should agree with a linear scan");
+        check(sorted, "Matches should be listed most specific first");
+
+        index.matches(addresses[0], found);
+        check(found.size() >= 3 && std::count(found.begin(), found.end(), table.find("10.1.0.0/16")) == 1 &&
+                  std::count(found.begin(), found.end(), table.find("10.1.0.7/16")) == 1,
+              "Prefixes that differ in host bits should both match");
+        check(index.longestMatch(v6, [](uint32_t) { return true; }) == table.find("2001:db8:1::/48"),
+              "IPv6 lookups should find the /48");
+    }
+
+    // Test 3: a subprefix hijack pulls traffic for the covered addresses only,
+    // except at ASes that drop the invalid subprefix
+    {
+        ASGraph g;
+        for (uint32_t a = 1; a <= 5; ++a) g.addNode(a);
+        g.addProvider(1, 2);
+        g.addProvider(1, 3);
+        g.addProvider(2, 4);
+        g.addProvider(3, 5);
+        g.setROV(2);
+        uint32_t legit = g.internPrefix("1.2.0.0/16");
+        uint32_t hijack = g.internPrefix("1.2.3.0/24");
+        g.seedAnnouncement(4, Announcement(legit, 4));
+        Announcement sub(hijack, 5);
+        sub.rov_invalid = true;
+        g.seedAnnouncement(5, sub);
+        g.propagateAnnouncements();
+
+        std::vector<Prefix> addresses(3);
+        parseAddress("1.2.3.9", addresses[0]);
+        parseAddress("1.2.200.1", addresses[1]);
+        parseAddress("9.9.9.9", addresses[2]);
+        std::vector<uint32_t> out;
+
+        g.routesFor(1, addresses, out);
+        check(out == std::vector<uint32_t>({hijack, legit, PrefixTable::kInvalid}),
+              "AS1 should send the covered address to the subprefix");
+        g.routesFor(2, addresses, out);
+        check(out[0] == legit && out[1] == legit, "The ROV AS should fall back to the covering prefix");
+        check(g.routeFor(4, addresses[0]) == legit, "AS4 never learns the subprefix (AS2 drops it)");
+        check(g.routeFor(99, addresses[0]) == PrefixTable::kInvalid, "Unknown ASes match nothing");
+    }
+
+    if (errors == 0) {
+        std::cout << "Prefix index tests passed." << std::endl;
+        return 0;
+    } else {
+        std::cerr << errors << " prefix index test(s) failed." << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,243 @@
+// g++ -std=c++17 -pthread -I include $(ls src/*.cpp | grep -v main.cpp) tests/test_rib.cpp -o tests/run_rib -lz -lbz2
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/ASGraph.h"
+#include "../include/BGP.h"
+#include "../include/PhaseArena.h"
+#include "../include/RIBStore.h"
+#include "../include/RouteKey.h"
+
+int main() {
+    int errors = 0;
+    auto check = [&](bool cond, const std::string& msg) {
+        if (!cond) {
+            std::cerr << "FAILED: " << msg << std::endl;
+            ++errors;
+        }
+    };
+
+    // Test 1: paths share their tails
+    {
+        PathPool pool;
+        uint32_t origin = pool.append({3u, 4u});
+        uint32_t longer = pool.push(2u, origin);
+        std::vector<uint32_t> path;
+        pool.materialize(longer, path);
+        check(path == std::vector<uint32_t>({2u, 3u, 4u}), "A pushed cell should extend the existing path");
+        check(pool.size() == 3, "Extending a path should add one cell");
+        pool.materialize(PathPool::kEnd, path);
+        check(path.empty(), "kEnd should be the empty path");
+    }
+
+    // Test 2: sparse tables stay sorted and switch to dense columns once enough ASes hold a route
+    {
+        const size_t n = 64;
+        PrefixRIB rib;
+        RouteEntry e;
+        e.rel = BGP::rankOf(Relationship::Customer);
+        for (uint32_t node : {40u, 7u, 21u}) {
+            e.next_hop = node;
+            rib.set(node, e, n);
+        }
+        RouteEntry out;
+        check(!rib.dense() && rib.count() == 3, "A few routes should be stored sparsely");
+        check(rib.find(21u, out) && out.next_hop == 21u, "Sparse lookup should find a stored route");
+        check(!rib.find(22u, out), "Sparse lookup should miss ASes without a route");
+
+        for (uint32_t node = 0; node < n / PrefixRIB::kDenseFraction + 1; ++node) {
+            e.next_hop = 1000 + node;
+            rib.set(node, e, n);
+        }
+        check(rib.dense(), "The table should become dense past 1/kDenseFraction of the ASes");
+        check(rib.find(40u, out) && out.next_hop == 40u, "Routes should survive the switch to dense columns");
+        check(rib.find(7u, out) && out.next_hop == 1007u, "Replacing a route should not add a second one");
+
+        // Round trip through the working columns; a near-empty result goes back to sparse
+        RouteColumns work;
+        rib.scatter(work, n);
+        check(work.size() == n && work.rel[40] != 0 && work.rel[41] == 0, "scatter should produce one row per AS");
+        for (uint32_t i = 1; i < n; ++i) work.rel[i] = 0;
+        rib.gather(work);
+        check(!rib.dense() && rib.count() == 1 && rib.find(0u, out), "gather should pick the sparse layout for one route");
+    }
+
+    // Test 3: route selection order
+    {
+        RouteEntry customer{BGP::rankOf(Relationship::Customer), 5, 9, PathPool::kEnd};
+        RouteEntry peer{BGP::rankOf(Relationship::Peer), 2, 1, PathPool::kEnd};
+        RouteEntry shorter = customer;
+        shorter.len = 4;
+        RouteEntry lower_hop = customer;
+        lower_hop.next_hop = 8;
+        check(BGP::better(customer, peer) && !BGP::better(peer, customer), "Relationship should decide first");
+        check(BGP::better(shorter, customer), "Shorter paths should win among equal relationships");
+        check(BGP::better(lower_hop, customer), "Lower next hops should break ties");
+        check(!BGP::better(customer, customer), "Equal routes should not replace each other");
+        check(BGP::better(peer, RouteEntry{}), "Any route should beat an empty entry");
+    }
+
+    // Test 4: a prefix that only reaches part of the graph is stored sparsely
+    // but answers queries like a dense one
+    {
+        ASGraph g;
+        for (uint32_t c = 10; c < 60; ++c) g.addProvider(1u, c);
+        g.addProvider(2u, 1u);
+        for (uint32_t c = 10; c < 60; ++c) g.setROV(c);
+
+        Announcement ann(g.internPrefix("203.0.113.0/24"), 2u);
+        ann.rov_invalid = true;
+        g.seedAnnouncement(2u, ann);
+        g.propagateAnnouncements();
+
+        auto r1 = g.getRoute(1u, g.prefixId("203.0.113.0/24"));
+        check(r1.has_value() && r1->as_path == std::vector<uint32_t>({1u, 2u}) &&
+                  r1->received_from == Relationship::Provider && r1->rov_invalid,
+              "AS1 should hold the provider route (1, 2)");
+        check(!g.getRoute(10u, g.prefixId("203.0.113.0/24")), "ROV customers should drop the invalid route");
+        check(!g.getRoute(99u, g.prefixId("203.0.113.0/24")), "Unknown ASes have no route");
+
+        const PropagationStats &stats = g.propagationStats();
+        check(stats.prefixes == 1 && stats.offers == 1, "Only the offer to AS1 should pass the import filters");
+    }
+
+    // Test 5: the offer arena grows to the high-water mark of a step, after
+    // which a step of the same size stays off the heap
+    {
+        PhaseArena arena;
+        auto fill = [&](size_t n) {
+            std::pmr::vector<RouteOffer> offers(arena.resource());
+            for (size_t i = 0; i < n; ++i) offers.push_back({uint32_t(i), 0, 0, PathPool::kEnd, 0});
+            return offers.size();
+        };
+        const size_t big = 3 * arena.capacity() / sizeof(RouteOffer);
+        fill(big);
+        arena.reset();
+        uint64_t spills = arena.heapBlocks();
+        check(spills > 0, "A step larger than the buffer should spill to the heap");
+        fill(big);
+        arena.reset();
+        check(arena.heapBlocks() == spills, "After a reset the buffer should hold a step of the same size");
+        check(arena.resets() == 2, "Each reset should be counted");
+    }
+
+    // Test 6: streaming and queued receive modes select the same routes
+    {
+        ASGraph graphs[2];
+        graphs[1].setReceiveMode(ReceiveMode::Queued);
+        for (ASGraph &g : graphs) {
+            // Layered graph with several equally good paths per AS
+            for (uint32_t a = 1; a <= 40; ++a) {
+                uint32_t layer = (a - 1) / 10;
+                if (layer < 3) {
+                    g.addProvider(a + 10, a);
+                    g.addProvider(11 + layer * 10 + a % 10, a);
+                }
+                if (a % 10 != 0) g.addPeer(a, a + 1);
+            }
+            g.setROV(23u);
+            Announcement valid(g.internPrefix("10.0.0.0/8"), 5u);
+            Announcement hijack(g.internPrefix("10.0.0.0/8"), 37u);
+            hijack.rov_invalid = true;
+            g.seedAnnouncement(5u, valid);
+            g.seedAnnouncement(37u, hijack);
+            g.propagateAnnouncements();
+        }
+
+        bool same = true;
+        for (uint32_t a = 1; a <= 40; ++a) {
+            auto s = graphs[0].getRoute(a, 0);
+            auto q = graphs[1].getRoute(a, 0);
+            same = same && s.has_value() == q.has_value();
+            if (s && q) same = same && s->as_path == q->as_path && s->received_from == q->received_from;
+        }
+        check(same, "Both receive modes should produce identical RIBs");
+        check(graphs[0].propagationStats().offers == graphs[1].propagationStats().offers,
+              "Both receive modes should see the same offers");
+        check(graphs[0].propagationStats().peak_pending <= graphs[0].size(),
+              "Streaming should hold at most one pending offer per AS");
+    }
+
+    // Test 7: packed keys order routes exactly like BGP::better, and every
+    // min-reduction picks the comparator's winner
+    {
+        uint32_t state = 12345;
+        auto next = [&]() {
+            state = state * 1664525u + 1013904223u;
+            return state >> 8;
+        };
+        // Few distinct values so that ties on rank and length are common
+        auto randomRoute = [&]() {
+            RouteEntry e;
+            e.rel = static_cast<uint8_t>(next() % 5);
+            if (e.rel != 0) e.rel |= (next() % 2 ? RouteEntry::kROVInvalid : 0) | (next() % 4) << 3;
+            e.len = next() % 6;
+            e.next_hop = next() % 2 ? next() % 8 : 0xffffff00u + next() % 256;
+            return e;
+        };
+
+        bool ordered = true;
+        for (int k = 0; k < 20000; ++k) {
+            RouteEntry a = randomRoute(), b = randomRoute();
+            if (a.rel == 0 && b.rel == 0) continue;  // the comparator is only used with a route on one side
+            ordered = ordered && (RouteKey::pack(a) < RouteKey::pack(b)) == BGP::better(a, b);
+        }
+        check(ordered, "Key order should match BGP::better");
+
+        bool same = true;
+        std::vector<uint64_t> keys;
+        for (size_t n = 0; n < 200; ++n) {
+            keys.clear();
+            RouteEntry winner;
+            size_t at = n;
+            for (size_t i = 0; i < n; ++i) {
+                RouteEntry e = randomRoute();
+                if (e.rel != 0 && (at == n || BGP::better(e, winner))) {
+                    winner = e;
+                    at = i;
+                }
+                keys.push_back(RouteKey::pack(e));
+            }
+            const uint64_t expected = at == n ? RouteKey::kNone : RouteKey::pack(winner);
+            same = same && RouteKey::minKey(keys.data(), n) == expected &&
+                   RouteKey::minKeyScalar(keys.data(), n) == expected;
+            if (at != n) same = same && RouteKey::argMin(keys.data(), n) == at;
+        }
+        check(same, "Vector and scalar reductions should pick the comparator's winner");
+    }
+
+    // Test 8: clearing routes keeps only the seeds' path cells, even for a
+    // seed appended after propagated cells
+    {
+        PrefixRIB rib;
+        RouteEntry seed;
+        seed.rel = BGP::rankOf(Relationship::Origin);
+        seed.path = rib.paths().append({9u, 10u});
+        rib.addSeed(0, seed);
+        uint32_t learned = seed.path;
+        for (uint32_t asn = 100; asn < 200; ++asn) learned = rib.paths().push(asn, learned);
+        seed.path = rib.paths().append({11u});
+        rib.addSeed(1, seed);
+
+        std::vector<uint32_t> path;
+        for (int round = 0; round < 3; ++round) {
+            rib.clearRoutes();
+            check(rib.paths().size() == 3, "clearRoutes should keep exactly the seeds' cells");
+            rib.paths().materialize(rib.seeds()[0].route.path, path);
+            check(path == std::vector<uint32_t>({9u, 10u}), "The first seed's path should survive clearRoutes");
+            rib.paths().materialize(rib.seeds()[1].route.path, path);
+            check(path == std::vector<uint32_t>({11u}), "A late seed's path should survive clearRoutes");
+            for (uint32_t asn = 100; asn < 150; ++asn) rib.paths().push(asn, rib.seeds()[0].route.path);
+        }
+    }
+
+    if (errors == 0) {
+        std::cout << "RIB store tests passed." << std::endl;
+        return 0;
+    } else {
+        std::cerr << errors << " RIB store test(s) failed." << std::endl;
+        return 1;
+    }
+}
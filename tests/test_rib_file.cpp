@@ -0,0 +1,122 @@
+// g++ -std=c++17 -pthread -I include $(ls src/*.cpp | grep -v main.cpp) tests/test_rib_file.cpp -o tests/run_rib_file -lz -lbz2
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/ASGraph.h"
+#include "../include/RIBFile.h"
+#include "TestHelpers.h"
+
+// Provider hierarchy with some peering; prefixes 0 and 3 are seeded alike, so
+// they share their paths
+static void buildScenario(ASGraph& g) {
+    TestRng rng(11);
+    const uint32_t num_ases = 600;
+    buildHierarchy(g, rng, {num_ases, 20, 8, 2, 200, 3});
+    for (uint32_t a = 1; a <= num_ases; a += 5) g.setROV(a * 3);
+    const std::vector<std::string> texts = {"10.2.0.0/16", "2001:db8::/32", "10.1.0.0/24", "172.16.0.0/12"};
+    const std::vector<uint32_t> origins = {300, 1200, 45, 300};
+    for (uint32_t p = 0; p < texts.size(); ++p) {
+        g.seedAnnouncement(origins[p], Announcement(g.internPrefix(texts[p]), origins[p]));
+    }
+    Announcement hijack(g.prefixId("10.1.0.0/24"), 1500);
+    hijack.rov_invalid = true;
+    g.seedAnnouncement(1500, hijack);
+    g.internPrefix("192.0.2.0/24");  // never announced
+    g.propagateAnnouncements();
+}
+
+int main() {
+    int errors = 0;
+    auto check = [&](bool cond, const std::string& msg) {
+        if (!cond) {
+            std::cerr << "FAILED: " << msg << std::endl;
+            ++errors;
+        }
+    };
+
+    ASGraph g;
+    buildScenario(g);
+    const std::string bin = "tests/tmp_ribs.bin", csv = "tests/tmp_ribs.csv";
+    const std::string converted = "tests/tmp_ribs_converted.csv";
+
+    // Test 1: point lookups return every route of the graph and nothing else
+    {
+        check(g.writeRIBFile(bin), "Writing the RIB file should succeed");
+        RIBFile ribs;
+        check(ribs.open(bin), "The RIB file should open");
+        check(ribs.rows() == g.routeCount(), "The file should hold one row per route");
+        check(ribs.paths() < ribs.rows(), "Shared paths should be stored once");
+        check(ribs.prefixCode("192.0.2.0/24") == RIBFile::kNoPrefix, "A prefix without a RIB is not listed");
+
+        bool same = true;
+        std::vector<uint32_t> path;
+        for (uint32_t p = 0; p < 4; ++p) {
+            const uint32_t code = ribs.prefixCode(g.prefixes().text(p));
+            same = same && code != RIBFile::kNoPrefix && ribs.prefixText(code) == g.prefixes().text(p);
+            for (uint32_t asn = 0; asn <= 1802; ++asn) {
+                auto route = g.getRoute(asn, p);
+                const bool found = ribs.find(asn, code, path);
+                same = same && found == route.has_value() && (!found || path == route->as_path);
+            }
+        }
+        check(same, "Point lookups should match the graph's routes");
+    }
+
+    // Test 2: range scans and the CSV converter reproduce the CSV dump
+    {
+        RIBFile ribs;
+        check(ribs.open(bin), "The RIB file should reopen");
+        uint64_t rows = 0;
+        bool in_range = true;
+        check(ribs.forEach(30, 90, [&](const RIBRow& r) {
+            ++rows;
+            in_range = in_range && r.asn >= 30 && r.asn <= 90;
+        }), "A range scan should succeed");
+        uint64_t expected = 0;
+        for (uint32_t asn = 30; asn <= 90; ++asn) {
+            for (uint32_t p = 0; p < 4; ++p) expected += g.getRoute(asn, p).has_value();
+        }
+        check(in_range && rows == expected, "A range scan should visit the rows of exactly its ASNs");
+
+        g.dumpRIBsToCSV(csv);
+        check(ribs.writeCSV(converted) && readFile(converted) == readFile(csv),
+              "The converted CSV should match the CSV dump byte for byte");
+
+        RIBDumpOptions sorted;
+        sorted.sort_prefixes = true;
+        ribs.close();
+        check(g.writeRIBFile(bin, sorted) && ribs.open(bin), "Writing a sorted RIB file should succeed");
+        g.dumpRIBsToCSV(csv, sorted);
+        check(ribs.writeCSV(converted) && readFile(converted) == readFile(csv),
+              "A sorted RIB file should convert to the sorted CSV dump");
+    }
+
+    // Test 3: damaged files are rejected
+    {
+        std::string bytes = readFile(bin);
+        RIBFile ribs;
+        std::ofstream(bin, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+        check(!ribs.open(bin), "A truncated file should be rejected");
+        bytes[0] = 'X';
+        std::ofstream(bin, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        check(!ribs.open(bin), "A file without the magic should be rejected");
+        check(!ribs.open("tests/does_not_exist.bin"), "A missing file should be rejected");
+    }
+
+    std::remove(bin.c_str());
+    std::remove(csv.c_str());
+    std::remove(converted.c_str());
+
+    if (errors == 0) {
+        std::cout << "RIB file tests passed." << std::endl;
+        return 0;
+    } else {
+        std::cerr << errors << " RIB file test(s) failed." << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,140 @@
+// g++ -std=c++17 -pthread -I include $(ls src/*.cpp | grep -v main.cpp) tests/test_rib_sinks.cpp -o tests/run_rib_sinks -lz -lbz2
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../include/ASGraph.h"
+#include "../include/RIBFile.h"
+#include "../include/RIBSinks.h"
+#include "TestHelpers.h"
+
+static const std::vector<std::string> kPrefixes = {"10.0.0.0/16", "10.1.0.0/16", "2001:db8::/32", "10.0.0.0/24"};
+
+// Provider hierarchy with some peering; prefix 3 is a subprefix hijack
+static void buildScenario(ASGraph& g) {
+    TestRng rng(21);
+    const uint32_t num_ases = 700;
+    buildHierarchy(g, rng, {num_ases, 20, 8, 2, 250});
+    for (uint32_t a = 1; a <= num_ases; a += 4) g.setROV(a);
+    const std::vector<uint32_t> origins = {120, 450, 33, 610};
+    for (uint32_t p = 0; p < kPrefixes.size(); ++p) {
+        Announcement ann(g.internPrefix(kPrefixes[p]), origins[p]);
+        ann.rov_invalid = p == 3;
+        g.seedAnnouncement(origins[p], ann);
+    }
+    Announcement hijack(g.prefixId("10.0.0.0/16"), 610);
+    hijack.rov_invalid = true;
+    g.seedAnnouncement(610, hijack);
+    g.propagateAnnouncements();
+}
+
+int main() {
+    int errors = 0;
+    auto check = [&](bool cond, const std::string& msg) {
+        if (!cond) {
+            std::cerr << "FAILED: " << msg << std::endl;
+            ++errors;
+        }
+    };
+
+    ASGraph g;
+    buildScenario(g);
+    const std::string csv = "tests/tmp_sink_ribs.csv", dump = "tests/tmp_sink_dump.csv";
+    const std::string bin = "tests/tmp_sink_ribs.bin";
+    const std::string origins = "tests/tmp_sink_origins.csv", lengths = "tests/tmp_sink_lengths.csv";
+
+    // Test 1: one pass feeds the CSV, binary and stats sinks
+    {
+        RIBCSVWriter rows(csv);
+        RIBFileWriter file(bin);
+        PrefixStatsSink stats(origins, lengths);
+        check(g.visitRIBs({}, {&rows, &file, &stats}), "The pass should succeed");
+        g.dumpRIBsToCSV(dump);
+        check(readFile(csv) == readFile(dump), "The CSV sink should match dumpRIBsToCSV");
+        RIBFile ribs;
+        check(ribs.open(bin) && ribs.rows() == g.routeCount(), "The binary sink should hold every route");
+
+        bool same = true;
+        for (uint32_t p = 0; p < kPrefixes.size(); ++p) {
+            std::map<uint32_t, uint64_t> by_origin;
+            std::vector<uint64_t> by_length;
+            for (uint32_t asn = 1; asn <= g.size(); ++asn) {
+                auto route = g.getRoute(asn, p);
+                if (!route) continue;
+                ++by_origin[route->as_path.back()];
+                if (by_length.size() <= route->as_path.size()) by_length.resize(route->as_path.size() + 1, 0);
+                ++by_length[route->as_path.size()];
+            }
+            const auto &counted = stats.origins(p);
+            same = same && counted.size() == by_origin.size() && stats.pathLengths(p) == by_length;
+            for (const auto &[origin, ases] : by_origin) {
+                auto it = counted.find(origin);
+                same = same && it != counted.end() && it->second == ases;
+            }
+        }
+        check(same, "Origin and path length counts should match the routes");
+        check(stats.origins(0).size() == 2 && stats.origins(0).count(610),
+              "The hijacked prefix should show both origins");
+
+        const std::string text = readFile(origins);
+        check(text.rfind("prefix,origin,ases\n10.0.0.0/16,120,", 0) == 0,
+              "Origin counts should be written by prefix, then origin");
+        check(readFile(lengths).rfind("prefix,path_length,ases\n10.0.0.0/16,1,2\n", 0) == 0,
+              "Path length counts should be written by prefix, then length");
+    }
+
+    // Test 2: ASN and prefix filters keep only the monitored routes, in every writer
+    {
+        RIBDumpOptions options;
+        options.asns = std::vector<uint32_t>{650, 7, 99999, 610, 300, 7};
+        options.prefixes = std::vector<uint32_t>{3, 1};
+        RIBCSVWriter rows(csv);
+        PrefixStatsSink stats(origins, lengths);
+        check(g.visitRIBs(options, {&rows, &stats}), "A filtered pass should succeed");
+
+        std::string expected = "asn,prefix,as_path\n";
+        uint64_t counted = 0;
+        for (uint32_t asn : {7u, 300u, 610u, 650u}) {
+            for (uint32_t p : {1u, 3u}) {
+                auto route = g.getRoute(asn, p);
+                if (!route) continue;
+                appendRIBRow(expected, asn, kPrefixes[p], route->as_path.data(), route->as_path.size());
+                ++counted;
+            }
+        }
+        check(readFile(csv) == expected, "The filtered CSV should list the monitored routes in order");
+        uint64_t total = 0;
+        for (uint32_t slot = 0; slot < 2; ++slot) {
+            for (const auto &entry : stats.origins(slot)) total += entry.second;
+        }
+        check(counted >= 4 && total == counted, "Stats should count only the monitored routes");
+
+        options.threads = 3;
+        g.dumpRIBsToCSV(dump, options);
+        check(readFile(dump) == expected, "dumpRIBsToCSV should apply the same filters");
+        RIBFile ribs;
+        check(g.writeRIBFile(bin, options) && ribs.open(bin) && ribs.rows() == counted && ribs.prefixCount() == 2,
+              "The binary writer should apply the same filters");
+    }
+
+    // Test 3: a sink that cannot open its file stops the pass
+    {
+        RIBCSVWriter rows(csv);
+        PrefixStatsSink stats("tests/no_such_dir/origins.csv", lengths);
+        check(!g.visitRIBs({}, {&rows, &stats}), "A failing sink should fail the pass");
+    }
+
+    for (const std::string &f : {csv, dump, bin, origins, lengths}) std::remove(f.c_str());
+
+    if (errors == 0) {
+        std::cout << "RIB sink tests passed." << std::endl;
+        return 0;
+    } else {
+        std::cerr << errors << " RIB sink test(s) failed." << std::endl;
+        return 1;
+    }
+}
@@ -1,9 +1,18 @@
 #include <iostream>
+#include <memory>
 #include <string>
 #include <cstdlib>
+#include <vector>
 
 #include "../include/ASGraph.h"
 #include "../include/Announcement.h"
+#include "../include/BGP.h"
+
+// Policy outside the built-in import rules: accepts nothing it did not originate
+class DropAll : public Policy {
+public:
+    bool acceptsAnnouncement(bool) const override { return false; }
+};
 
 static void fail(const std::string &msg) {
     std::cerr << "FAILED: " << msg << std::endl;
@@ -20,13 +29,13 @@ int main() {
         g.setROV(2u);
 
         // Seed an invalid (hijack) announcement at AS1
-        Announcement bad("1.2.0.0/16", 666u, Relationship::Customer, std::vector<uint32_t>{666u}, true);
+        Announcement bad(g.internPrefix("1.2.0.0/16"), 666u, Relationship::Customer, std::vector<uint32_t>{666u}, true);
         g.seedAnnouncement(1u, bad);
 
         g.propagateAnnouncements();
 
         // AS2 should have dropped and not stored the announcement
-        if (g.get(2u)->policy->getLocalRIB().find("1.2.0.0/16") != g.get(2u)->policy->getLocalRIB().end()) {
+        if (g.getRoute(2u, g.prefixId("1.2.0.0/16")).has_value()) {
             fail("AS2 should not store ROV-invalid announcement");
         }
     }
@@ -37,11 +46,11 @@ int main() {
         g.addProvider(2u, 1u);
         // AS2 is NOT ROV
 
-        Announcement bad("1.2.0.0/16", 666u, Relationship::Customer, std::vector<uint32_t>{666u}, true);
+        Announcement bad(g.internPrefix("1.2.0.0/16"), 666u, Relationship::Customer, std::vector<uint32_t>{666u}, true);
         g.seedAnnouncement(1u, bad);
         g.propagateAnnouncements();
 
-        if (g.get(2u)->policy->getLocalRIB().find("1.2.0.0/16") == g.get(2u)->policy->getLocalRIB().end()) {
+        if (!g.getRoute(2u, g.prefixId("1.2.0.0/16"))) {
             fail("AS2 should store invalid announcement if it is not ROV");
         }
     }
@@ -52,15 +61,84 @@ int main() {
         g.addProvider(2u, 1u);
         g.setROV(2u);
 
-        Announcement good("1.2.0.0/16", 1u);
+        Announcement good(g.internPrefix("1.2.0.0/16"), 1u);
         g.seedAnnouncement(1u, good);
         g.propagateAnnouncements();
 
-        if (g.get(2u)->policy->getLocalRIB().find("1.2.0.0/16") == g.get(2u)->policy->getLocalRIB().end()) {
+        if (!g.getRoute(2u, g.prefixId("1.2.0.0/16"))) {
             fail("AS2 (ROV) should accept non-invalid announcements");
         }
     }
 
+    // Test D: one graph swept over several ROV sets gives the same routes as
+    // a fresh graph per set, and keeps its seeds between scenarios
+    {
+        ASGraph g;
+        // 1 -> 2 -> 3 (customer -> provider), 4 is another customer of 3
+        g.addProvider(2u, 1u);
+        g.addProvider(3u, 2u);
+        g.addProvider(3u, 4u);
+        uint32_t prefix = g.internPrefix("1.2.0.0/16");
+        g.seedAnnouncement(4u, Announcement(prefix, 4u));
+        Announcement bad(prefix, 1u, Relationship::Origin, std::vector<uint32_t>{1u}, true);
+        g.seedAnnouncement(1u, bad);
+
+        const std::vector<std::vector<uint32_t>> sets = {{2u}, {3u}, {}, {1u}};
+        for (const auto &rov : sets) {
+            g.resetPolicies();
+            for (uint32_t asn : rov) g.setROV(asn);
+            g.resetRoutes();
+            g.propagateAnnouncements();
+
+            ASGraph fresh;
+            fresh.addProvider(2u, 1u);
+            fresh.addProvider(3u, 2u);
+            fresh.addProvider(3u, 4u);
+            fresh.internPrefix("1.2.0.0/16");
+            for (uint32_t asn : rov) fresh.setROV(asn);
+            fresh.seedAnnouncement(4u, Announcement(prefix, 4u));
+            fresh.seedAnnouncement(1u, bad);
+            fresh.propagateAnnouncements();
+
+            for (uint32_t asn = 1; asn <= 4; ++asn) {
+                auto swept = g.getRoute(asn, prefix);
+                auto expected = fresh.getRoute(asn, prefix);
+                if (swept.has_value() != expected.has_value() || (swept && swept->as_path != expected->as_path)) {
+                    fail("Sweep scenario should match a fresh graph at AS" + std::to_string(asn));
+                }
+            }
+        }
+        // In the last scenario AS1 drops its own invalid seed, so it and AS2 use the valid route
+        auto route = g.getRoute(1u, prefix);
+        if (!route || route->as_path != std::vector<uint32_t>({1u, 2u, 3u, 4u})) {
+            fail("AS1 should learn the valid route once ROV drops its invalid seed");
+        }
+    }
+
+    // Test E: a custom policy is still consulted when no route is ROV invalid
+    // (built-in rules skip filtering for such prefixes)
+    {
+        ASGraph g;
+        g.addProvider(2u, 1u);
+        g.addProvider(3u, 2u);
+        g.setROV(3u);
+        g.get(2u)->policy = std::make_unique<DropAll>();
+        uint32_t prefix = g.internPrefix("1.2.0.0/16");
+        g.seedAnnouncement(1u, Announcement(prefix, 1u));
+        g.propagateAnnouncements();
+        if (g.getRoute(2u, prefix).has_value() || g.getRoute(3u, prefix).has_value()) {
+            fail("AS2's custom policy should drop the route");
+        }
+
+        // Back to built-in rules only
+        g.get(2u)->policy = std::make_unique<BGP>();
+        g.resetRoutes();
+        g.propagateAnnouncements();
+        if (!g.getRoute(3u, prefix).has_value()) {
+            fail("AS3 should get the valid route once AS2 runs BGP");
+        }
+    }
+
     std::cout << "ROV tests passed." << std::endl;
     return 0;
 }
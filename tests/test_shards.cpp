@@ -0,0 +1,115 @@
+// g++ -std=c++17 -pthread -I include $(ls src/*.cpp | grep -v main.cpp) tests/test_shards.cpp -o tests/run_shards -lz -lbz2
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/ASGraph.h"
+#include "../include/ShardMerge.h"
+#include "TestHelpers.h"
+
+static const char* kAnns = "tests/tmp_shard_anns.csv";
+
+// Provider hierarchy with some peering, loaded with the announcements file
+static void buildScenario(ASGraph& g, const PrefixShard& shard) {
+    TestRng rng(9);
+    const uint32_t num_ases = 400;
+    buildHierarchy(g, rng, {num_ases, 20, 8, 2, 150});
+    for (uint32_t a = 1; a <= num_ases; a += 6) g.setROV(a);
+    g.setPrefixShard(shard);
+    g.loadAnnouncementsFromFile(kAnns);
+    g.propagateAnnouncements();
+}
+
+int main() {
+    int errors = 0;
+    auto check = [&](bool cond, const std::string& msg) {
+        if (!cond) {
+            std::cerr << "FAILED: " << msg << std::endl;
+            ++errors;
+        }
+    };
+
+    // Test 1: shard specs
+    {
+        PrefixShard s;
+        check(parsePrefixShard("2/5", s) && s.index == 2 && s.count == 5, "2/5 should parse");
+        check(!parsePrefixShard("0/3", s) && !parsePrefixShard("4/3", s) && !parsePrefixShard("1/", s) &&
+                  !parsePrefixShard("a/2", s),
+              "Out-of-range or malformed shards should be rejected");
+
+        // Membership is part of the manifest contract: a fixed 64-bit hash
+        Prefix v4, v6;
+        parsePrefix("10.0.0.0/8", v4);
+        parsePrefix("2001:db8::/32", v6);
+        check(prefixShardHash(v4) == 0xc07e80c3b5760a63ull && prefixShardHash(v6) == 0x966ff7d5b00a822full,
+              "The shard hash should not change between builds or hosts");
+        PrefixShard owner{static_cast<unsigned>(0xc07e80c3b5760a63ull % 7) + 1, 7};
+        check(owner.contains(v4), "A prefix should belong to shard hash % N + 1");
+    }
+
+    {
+        std::ofstream anns(kAnns);
+        anns << "seed_asn,prefix,rov_invalid\n";
+        for (uint32_t p = 0; p < 30; ++p) {
+            anns << 50 + 7 * p << ",10." << p << ".0.0/16,False\n";
+            if (p % 4 == 0) anns << 300 + p << ",10." << p << ".0.0/16,True\n";
+            if (p % 5 == 0) anns << 200 + p << ",10." << p << ".1.0/24,True\n";
+        }
+    }
+
+    // Test 2: every prefix lands in exactly one shard, and merging the shard
+    // outputs gives the unsharded ribs.csv byte for byte
+    {
+        ASGraph whole;
+        buildScenario(whole, PrefixShard());
+        whole.dumpRIBsToCSV("tests/tmp_shard_whole.csv");
+
+        const unsigned count = 3;
+        std::vector<std::string> manifests;
+        size_t prefixes = 0;
+        bool all_used = true;
+        for (unsigned i = 1; i <= count; ++i) {
+            ASGraph g;
+            buildScenario(g, PrefixShard{i, count});
+            prefixes += g.prefixes().size();
+            all_used = all_used && g.prefixes().size() > 0;
+            const std::string name = "tmp_shard_" + std::to_string(i) + ".csv";
+            g.dumpRIBsToCSV("tests/" + name);
+            manifests.push_back("tests/tmp_shard_" + std::to_string(i) + ".manifest");
+            check(writeShardManifest(g, name, manifests.back()), "Writing a manifest should succeed");
+        }
+        check(prefixes == whole.prefixes().size() && all_used, "The shards should split the prefixes");
+
+        ShardManifest m;
+        check(readShardManifest(manifests[1], m) && m.shard.index == 2 && m.shard.count == 3 &&
+                  m.ribs == "tmp_shard_2.csv",
+              "A manifest should read back");
+
+        check(mergeShards(manifests, "tests/tmp_shard_merged.csv"), "Merging all shards should succeed");
+        check(readFile("tests/tmp_shard_merged.csv") == readFile("tests/tmp_shard_whole.csv"),
+              "The merged output should match the unsharded run");
+
+        check(!mergeShards({manifests[0], manifests[2]}, "tests/tmp_shard_merged.csv"),
+              "A missing shard should be an error");
+        check(!mergeShards({manifests[0], manifests[1], manifests[1]}, "tests/tmp_shard_merged.csv"),
+              "A repeated shard should be an error");
+
+        for (const std::string &f : manifests) std::remove(f.c_str());
+        for (unsigned i = 1; i <= count; ++i) std::remove(("tests/tmp_shard_" + std::to_string(i) + ".csv").c_str());
+        std::remove("tests/tmp_shard_whole.csv");
+        std::remove("tests/tmp_shard_merged.csv");
+    }
+    std::remove(kAnns);
+
+    if (errors == 0) {
+        std::cout << "Shard tests passed." << std::endl;
+        return 0;
+    } else {
+        std::cerr << errors << " shard test(s) failed." << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,123 @@
+// g++ -std=c++17 -pthread -I include $(ls src/*.cpp | grep -v main.cpp) tests/test_snapshot.cpp -o tests/run_snapshot -lz -lbz2
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+#include "../include/ASGraph.h"
+#include "../include/GraphSnapshot.h"
+
+int main() {
+    int errors = 0;
+    auto check = [&](bool cond, const std::string& msg) {
+        if (!cond) {
+            std::cerr << "FAILED: " << msg << std::endl;
+            ++errors;
+        }
+    };
+
+    const std::string fn = "tests/tmp_graph.snap";
+
+    // Source graph: chain 1 -> 2 -> 3, peer 2 <-> 4
+    ASGraph g;
+    g.addProvider(1u, 2u);
+    g.addProvider(2u, 3u);
+    g.addPeer(2u, 4u);
+    check(g.writeSnapshot(fn), "Writing the snapshot should succeed");
+    check(isGraphSnapshot(fn), "Written file should be recognised as a snapshot");
+    check(!isGraphSnapshot("tests/sample_edges.txt"), "Text relationship file should not be recognised as a snapshot");
+
+    // Test 1: loaded snapshot reproduces adjacency and ranks
+    {
+        ASGraph loaded;
+        check(loaded.loadSnapshot(fn), "Loading the snapshot should succeed");
+        check(loaded.size() == 4, "Snapshot should contain 4 ASes");
+        check(loaded.customersOf(1u) == std::vector<uint32_t>{2u}, "AS1 should have customer 2 after loading");
+        check(loaded.providersOf(3u) == std::vector<uint32_t>{2u}, "AS3 should have provider 2 after loading");
+        check(loaded.peersOf(4u) == std::vector<uint32_t>{2u}, "AS4 should peer with 2 after loading");
+        check(!loaded.hasProviderCycle(), "Snapshot graph should not report a cycle");
+        check(loaded.get(1u)->_propagation_rank == 2, "AS1 rank should be restored from the snapshot");
+        check(loaded.flattenByProviders() == g.flattenByProviders(), "Ranks should match the source graph");
+    }
+
+    // Test 2: propagation on a loaded snapshot matches the source graph, and new
+    // seed ASes / edges can still be added on top of it
+    {
+        ASGraph loaded;
+        loaded.loadSnapshot(fn);
+        loaded.addProvider(5u, 3u);
+        check(loaded.providersOf(3u) == std::vector<uint32_t>{2u, 5u}, "Edges added after loading should extend the graph");
+
+        Announcement ann(loaded.internPrefix("5.5.0.0/16"), 3u);
+        loaded.seedAnnouncement(3u, ann);
+        loaded.propagateAnnouncements();
+        auto r4 = loaded.getRoute(4u, loaded.prefixId("5.5.0.0/16"));
+        check(r4.has_value() && r4->as_path == std::vector<uint32_t>({4u, 2u, 3u}),
+              "AS4 should learn (4, 2, 3) over the loaded topology");
+        auto r5 = loaded.getRoute(5u, loaded.prefixId("5.5.0.0/16"));
+        check(r5.has_value(), "AS5 (added after loading) should learn the route");
+    }
+
+    // Test 3: truncated files and version mismatches are rejected
+    {
+        std::ifstream in(fn, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+
+        {
+            std::ofstream out(fn, std::ios::binary);
+            out.write(bytes.data(), bytes.size() / 2);
+        }
+        ASGraph truncated;
+        check(!truncated.loadSnapshot(fn), "Truncated snapshot should be rejected");
+
+        bytes[8] = static_cast<char>(kSnapshotVersion + 1);
+        {
+            std::ofstream out(fn, std::ios::binary);
+            out.write(bytes.data(), bytes.size());
+        }
+        ASGraph wrong_version;
+        check(!wrong_version.loadSnapshot(fn), "Snapshot with another version should be rejected");
+        bytes[8] = static_cast<char>(kSnapshotVersion);
+
+        // Corrupt rank buckets, duplicated nodes and duplicated ASNs are rejected
+        // (layout: header, asns, rank_offsets, rank_nodes, each 8-byte aligned)
+        auto padded = [](size_t b) { return (b + 7) & ~size_t(7); };
+        SnapshotHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        const size_t asns_at = padded(sizeof(header));
+        const size_t offsets_at = asns_at + padded(header.num_nodes * sizeof(uint32_t));
+        const size_t nodes_at = offsets_at + padded((header.num_ranks + 1) * sizeof(uint32_t));
+        auto rejects = [&](size_t at, uint32_t value) {
+            std::string corrupt = bytes;
+            std::memcpy(&corrupt[at], &value, sizeof(value));
+            {
+                std::ofstream out(fn, std::ios::binary);
+                out.write(corrupt.data(), corrupt.size());
+            }
+            ASGraph bad;
+            return !bad.loadSnapshot(fn);
+        };
+        uint32_t first_node, first_asn;
+        std::memcpy(&first_node, &bytes[nodes_at], sizeof(first_node));
+        std::memcpy(&first_asn, &bytes[asns_at], sizeof(first_asn));
+        check(rejects(offsets_at, 1), "Snapshot whose first rank does not start at 0 should be rejected");
+        check(rejects(nodes_at, 100000000), "Snapshot with an out of range rank node should be rejected");
+        check(rejects(nodes_at + sizeof(uint32_t), first_node), "Snapshot listing a node in two ranks should be rejected");
+        check(rejects(asns_at + sizeof(uint32_t), first_asn), "Snapshot with duplicate ASNs should be rejected");
+        check(!rejects(nodes_at, first_node), "Unmodified snapshot should still load");
+    }
+
+    std::remove(fn.c_str());
+
+    if (errors == 0) {
+        std::cout << "Graph snapshot tests passed." << std::endl;
+        return 0;
+    } else {
+        std::cerr << errors << " snapshot test(s) failed." << std::endl;
+        return 1;
+    }
+}
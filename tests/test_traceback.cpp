@@ -0,0 +1,144 @@
+// g++ -std=c++17 -pthread -I include $(ls src/*.cpp | grep -v main.cpp) tests/test_traceback.cpp -o tests/run_traceback -lz -lbz2
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/ASGraph.h"
+#include "../include/Traceback.h"
+#include "TestHelpers.h"
+
+// Provider hierarchy with peering; a /16 with valid origins and a hijacked /24
+// inside it; deterministic for a given seed
+static void buildScenario(ASGraph& g, uint32_t seed) {
+    TestRng rng(seed);
+    const uint32_t num_ases = 1500;
+    buildHierarchy(g, rng, {num_ases, 30, 8, 2, 600});
+    // ROV at a third of the ASes and at the legitimate origins, so that part of
+    // the graph still reaches them
+    for (uint32_t a = 1; a <= num_ases; ++a) {
+        if ((a % 3 == 0 && a != 900) || a == 400 || a == 1200) g.setROV(a);
+    }
+
+    uint32_t covering = g.internPrefix("10.0.0.0/16");
+    uint32_t sub = g.internPrefix("10.0.7.0/24");
+    g.seedAnnouncement(400, Announcement(covering, 400));
+    g.seedAnnouncement(1200, Announcement(covering, 1200));
+    Announcement hijack(sub, 900);
+    hijack.rov_invalid = true;
+    g.seedAnnouncement(900, hijack);
+    g.propagateAnnouncements();
+}
+
+// Outcome from one AS, following routeFor/getRoute hop by hop
+static TraceOutcome walk(const ASGraph& g, uint32_t asn, const Prefix& dest) {
+    for (size_t hops = 0; hops <= g.size(); ++hops) {
+        uint32_t p = g.routeFor(asn, dest);
+        if (p == PrefixTable::kInvalid) return TraceOutcome::Blackhole;
+        auto route = g.getRoute(asn, p);
+        if (route->received_from == Relationship::Origin) {
+            return route->rov_invalid ? TraceOutcome::Attacker : TraceOutcome::Legitimate;
+        }
+        asn = route->next_hop_asn;
+    }
+    return TraceOutcome::Blackhole;
+}
+
+int main() {
+    int errors = 0;
+    auto check = [&](bool cond, const std::string& msg) {
+        if (!cond) {
+            std::cerr << "FAILED: " << msg << std::endl;
+            ++errors;
+        }
+    };
+
+    // Test 1: a subprefix hijack on a small graph
+    {
+        ASGraph g;
+        for (uint32_t a = 1; a <= 6; ++a) g.addNode(a);
+        g.addProvider(1, 2);
+        g.addProvider(1, 3);
+        g.addProvider(2, 4);
+        g.addProvider(3, 5);
+        g.setROV(2);
+        uint32_t legit = g.internPrefix("1.2.0.0/16");
+        uint32_t hijack = g.internPrefix("1.2.3.0/24");
+        g.seedAnnouncement(4, Announcement(legit, 4));
+        Announcement sub(hijack, 5);
+        sub.rov_invalid = true;
+        g.seedAnnouncement(5, sub);
+        g.propagateAnnouncements();
+
+        Prefix inside, outside;
+        parseAddress("1.2.3.4", inside);
+        parseAddress("1.2.4.4", outside);
+        Traceback traceback(g);
+        std::vector<TraceOutcome> outcome;
+        TraceCounts c = traceback.trace(inside, outcome);
+        check(c.legitimate == 2 && c.attacker == 3 && c.blackhole == 1, "Covered address: 2 legitimate, 3 hijacked");
+        check(outcome[g.indexOf(2)] == TraceOutcome::Legitimate && outcome[g.indexOf(1)] == TraceOutcome::Attacker,
+              "The ROV AS should reach the origin, its provider the attacker");
+        check(outcome[g.indexOf(6)] == TraceOutcome::Blackhole, "An AS without routes is a black hole");
+
+        c = traceback.trace(outside, outcome);
+        check(c.legitimate == 5 && c.attacker == 0 && c.blackhole == 1, "Other addresses reach the origin");
+    }
+
+    // Test 2: memoized traces match hop-by-hop walks, at any thread count
+    {
+        ASGraph g;
+        buildScenario(g, 21);
+        std::vector<Prefix> dests(4);
+        parseAddress("10.0.7.1", dests[0]);
+        parseAddress("10.0.8.1", dests[1]);
+        parsePrefix("10.0.7.0/24", dests[2]);
+        parseAddress("192.168.0.1", dests[3]);
+
+        Traceback traceback(g);
+        std::vector<std::vector<TraceOutcome>> serial, parallel;
+        std::vector<TraceCounts> a = traceback.run(dests, 1, &serial);
+        std::vector<TraceCounts> b = traceback.run(dests, 3, &parallel);
+        check(serial == parallel, "Per-AS outcomes should not depend on the thread count");
+
+        bool same = true;
+        for (size_t d = 0; d < dests.size(); ++d) {
+            same = same && a[d].legitimate == b[d].legitimate && a[d].attacker == b[d].attacker &&
+                   a[d].legitimate + a[d].attacker + a[d].blackhole == g.size();
+            for (uint32_t i = 0; i < g.size(); ++i) same = same && serial[d][i] == walk(g, g.asnAt(i), dests[d]);
+        }
+        check(same, "Traces should match walking every AS separately");
+        check(a[0].attacker > 0 && a[0].legitimate > 0, "The hijack should split the graph");
+        check(a[1].attacker == 0 && a[3].blackhole == g.size(), "Only the subprefix is hijacked");
+        check(a[2].attacker == a[0].attacker, "A prefix destination should match like its addresses");
+    }
+
+    // Test 3: a seeded path whose next hop is not in the graph ends in a black
+    // hole instead of throwing (also on pool workers)
+    {
+        ASGraph g;
+        g.addProvider(4u, 3u);
+        uint32_t prefix = g.internPrefix("9.9.0.0/16");
+        g.seedAnnouncement(3u, Announcement(prefix, 9u, Relationship::Customer, std::vector<uint32_t>{9u, 8u, 3u}));
+        g.propagateAnnouncements();
+
+        std::vector<Prefix> dests(1);
+        parseAddress("9.9.1.1", dests[0]);
+        Traceback traceback(g);
+        std::vector<TraceOutcome> outcome;
+        TraceCounts c = traceback.trace(dests[0], outcome);
+        check(c.blackhole == 2 && outcome[g.indexOf(3)] == TraceOutcome::Blackhole,
+              "An unknown next hop should count as a black hole");
+        std::vector<TraceCounts> pooled = traceback.run(dests, 2);
+        check(pooled[0].blackhole == 2, "Pooled traces should treat an unknown next hop the same way");
+    }
+
+    if (errors == 0) {
+        std::cout << "Traceback tests passed." << std::endl;
+        return 0;
+    } else {
+        std::cerr << errors << " traceback test(s) failed." << std::endl;
+        return 1;
+    }
+}
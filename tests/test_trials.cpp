@@ -0,0 +1,116 @@
+// g++ -std=c++17 -pthread -I include $(ls src/*.cpp | grep -v main.cpp) tests/test_trials.cpp -o tests/run_trials -lz -lbz2
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/ASGraph.h"
+#include "../include/HijackTrials.h"
+#include "TestHelpers.h"
+
+// Provider hierarchy with some peering, one legitimate origin and one hijacker
+// per prefix
+static void buildScenario(ASGraph& g, const std::vector<uint32_t>& rov_asns) {
+    TestRng rng(3);
+    buildHierarchy(g, rng, {800, 20, 8, 2, 300});
+    for (uint32_t asn : rov_asns) g.setROV(asn);
+    for (uint32_t p = 0; p < 3; ++p) {
+        uint32_t prefix = g.internPrefix("10." + std::to_string(p) + ".0.0/16");
+        g.seedAnnouncement(100 + p, Announcement(prefix, 100 + p));
+        Announcement hijack(prefix, 700 + p);
+        hijack.rov_invalid = true;
+        g.seedAnnouncement(700 + p, hijack);
+    }
+}
+
+// Hijack success measured on fully propagated RIBs
+static double measure(const ASGraph& g) {
+    uint64_t hijacked = 0, eligible = 0;
+    for (uint32_t p = 0; p < 3; ++p) {
+        for (uint32_t asn = 1; asn <= g.size(); ++asn) {
+            if (asn == 100 + p || asn == 700 + p) continue;
+            ++eligible;
+            auto route = g.getRoute(asn, p);
+            hijacked += route && route->rov_invalid;
+        }
+    }
+    return double(hijacked) / double(eligible);
+}
+
+int main() {
+    int errors = 0;
+    auto check = [&](bool cond, const std::string& msg) {
+        if (!cond) {
+            std::cerr << "FAILED: " << msg << std::endl;
+            ++errors;
+        }
+    };
+
+    ASGraph g;
+    buildScenario(g, {});
+    HijackTrialRunner runner(g);
+    check(runner.hijackedPrefixes().size() == 3, "Every prefix has a hijacker");
+
+    // Test 1: a trial measures the same success as propagating the graph with
+    // the drawn ROV set
+    {
+        std::vector<uint8_t> rov = runner.adopters(30, 4, 9);
+        std::vector<uint32_t> rov_asns;
+        for (uint32_t i = 0; i < rov.size(); ++i) {
+            if (rov[i]) rov_asns.push_back(g.asnAt(i));
+        }
+        check(rov_asns.size() == 239, "30% of the 797 non-attacker ASes should adopt");
+        check(std::none_of(rov_asns.begin(), rov_asns.end(), [](uint32_t a) { return a >= 700 && a < 703; }),
+              "Attackers should never adopt");
+        check(runner.adopters(30, 4, 9) == rov, "The same trial should draw the same ASes");
+        check(runner.adopters(30, 5, 9) != rov, "Another trial should draw other ASes");
+
+        ASGraph full;
+        buildScenario(full, rov_asns);
+        full.propagateAnnouncements();
+        PrefixRIB rib;
+        PropagationScratch scratch;
+        double trial = runner.hijackSuccess(rov, rib, scratch);
+        check(std::fabs(trial - measure(full)) < 1e-12, "Trial success should match the propagated RIBs");
+
+        ASGraph plain;
+        buildScenario(plain, {});
+        plain.propagateAnnouncements();
+        double none = runner.hijackSuccess(std::vector<uint8_t>(g.size(), 0), rib, scratch);
+        check(std::fabs(none - measure(plain)) < 1e-12 && none > trial, "No adoption should match plain BGP");
+        check(!g.getRoute(1, 0).has_value(), "Trials should not touch the graph's own RIBs");
+    }
+
+    // Test 2: results do not depend on the thread count, and full adoption
+    // stops every hijack
+    {
+        HijackTrialConfig config;
+        config.adoption_percents = {0, 50, 100};
+        config.trials = 6;
+        config.seed = 42;
+        config.threads = 1;
+        auto serial = runner.run(config);
+        config.threads = 4;
+        auto parallel = runner.run(config);
+
+        bool same = serial.size() == 3 && parallel.size() == 3;
+        for (size_t l = 0; same && l < serial.size(); ++l) {
+            same = serial[l].mean == parallel[l].mean && serial[l].min == parallel[l].min &&
+                   serial[l].max == parallel[l].max && serial[l].stddev == parallel[l].stddev;
+        }
+        check(same, "Trial results should not depend on the thread count");
+        check(serial[0].stddev == 0 && serial[0].mean > serial[1].mean, "More adoption should mean fewer hijacks");
+        check(serial[2].adopters == 797 && serial[2].max == 0, "Full adoption should stop every hijack");
+        check(serial[2].stddev == 0, "Identical trials should report a stddev of exactly 0");
+    }
+
+    if (errors == 0) {
+        std::cout << "Hijack trial tests passed." << std::endl;
+        return 0;
+    } else {
+        std::cerr << errors << " trial test(s) failed." << std::endl;
+        return 1;
+    }
+}